@@ -0,0 +1,100 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QProcess>
+#include <QRegularExpression>
+
+#include <algorithm>
+
+// One typed step of an install plan. Actions name the actions they depend
+// on in after; everything that touches the dpkg lock runs one at a time,
+// the rest runs as soon as its dependencies are done.
+struct Action {
+    enum Kind { AptInstall, AptRemove, FetchUrl, DpkgInstall, Run };
+
+    QString id;
+    Kind kind = Run;
+    QStringList args;
+    QStringList after;
+
+    bool needsLock() const { return kind != FetchUrl; }
+
+    // Action and profile ids end up in the root session's progress markers
+    // and in the journal, so they are kept to plain words.
+    static bool validId(const QString& id) {
+        static const QRegularExpression word("^[A-Za-z0-9._-]+$");
+        return word.match(id).hasMatch();
+    }
+
+    // Catalog syntax: <id> <kind> [after:<id>,<id>] <args...>
+    static bool parse(const QString& spec, Action& out) {
+        QStringList tokens = QProcess::splitCommand(spec);
+        if (tokens.size() < 2) return false;
+        Action a;
+        a.id = tokens.takeFirst();
+        if (!validId(a.id)) return false;
+        const QString kind = tokens.takeFirst();
+        if (kind == "apt-install") a.kind = AptInstall;
+        else if (kind == "apt-remove") a.kind = AptRemove;
+        else if (kind == "fetch-url") a.kind = FetchUrl;
+        else if (kind == "dpkg-install") a.kind = DpkgInstall;
+        else if (kind == "run") a.kind = Run;
+        else return false;
+        if (!tokens.isEmpty() && tokens.first().startsWith("after:")) {
+            a.after = tokens.takeFirst().mid(6).split(',', Qt::SkipEmptyParts);
+            if (!std::all_of(a.after.cbegin(), a.after.cend(), validId)) return false;
+        }
+        if (tokens.isEmpty() || (a.kind == FetchUrl && tokens.size() != 2)) return false;
+        a.args = tokens;
+        out = a;
+        return true;
+    }
+
+    static QString quote(QString s) {
+        static const QRegularExpression safe("^[A-Za-z0-9_+=:,./@%-]+$");
+        if (safe.match(s).hasMatch()) return s;
+        return "'" + s.replace("'", "'\\''") + "'";
+    }
+
+    static QString quoteAll(const QStringList& list) {
+        QStringList out;
+        out.reserve(list.size());
+        for (const QString& s : list) out << quote(s);
+        return out.join(' ');
+    }
+
+    // Resolves a file argument of dpkg-install against the download dir.
+    static QString resolveFile(const QString& file, const QString& downloads) {
+        return file.contains('/') ? file : downloads + "/" + file;
+    }
+
+    // Shell command run in the root session; apt-get is wrapped there to
+    // report progress.
+    QString command(const QString& downloads) const {
+        switch (kind) {
+        case AptInstall: return "apt-get install " + quoteAll(args);
+        case AptRemove: return "apt-get remove " + quoteAll(args);
+        case DpkgInstall: {
+            QStringList files;
+            for (const QString& f : args) files << resolveFile(f, downloads);
+            return "dpkg -i " + quoteAll(files) + " || apt-get install -f";
+        }
+        case Run: return quoteAll(args);
+        case FetchUrl: break;
+        }
+        return QString();
+    }
+
+    // What the command preview shows for this action.
+    QString preview() const {
+        switch (kind) {
+        case AptInstall: return "sudo apt install -y " + quoteAll(args);
+        case AptRemove: return "sudo apt remove -y " + quoteAll(args);
+        case FetchUrl: return "wget -O " + quote(args.value(1)) + " " + quote(args.value(0));
+        case DpkgInstall: return "sudo dpkg -i " + quoteAll(args);
+        case Run: return "sudo " + quoteAll(args);
+        }
+        return QString();
+    }
+};
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QDir>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+
+#include "action.h"
+#include "installengine.h"
+#include "journal.h"
+
+// Runs an install plan as a dependency graph. Actions that need the dpkg
+// lock are fed one at a time to a single root session, downloads run
+// in-process alongside them. A failed action skips everything after it.
+// With a journal, actions it already has as done are not run again and
+// every action that finishes is recorded before the next one starts.
+class ActionScheduler : public QObject {
+    Q_OBJECT
+public:
+    explicit ActionScheduler(QObject* parent = nullptr) : QObject(parent) {
+        engine = new InstallEngine(this);
+        connect(engine, &InstallEngine::progressChanged, this, [this](int percent, const QString& text) {
+            // Downloads run alongside, so name the root action instead of
+            // guessing its position from the finished count.
+            emit progressChanged(percent, QString("[%1/%2 done] %3: %4")
+                                              .arg(doneCount)
+                                              .arg(plan.size())
+                                              .arg(lockAction, text));
+        });
+        connect(engine, &InstallEngine::logLine, this, &ActionScheduler::logLine);
+        connect(engine, &InstallEngine::actionFinished, this, [this](const QString& id, int code, const QString& error) {
+            lockBusy = false;
+            complete(id, code == 0, error.isEmpty() ? QString("%1 failed (exit code %2)").arg(id).arg(code) : error);
+        });
+        connect(engine, &InstallEngine::sessionEnded, this, &ActionScheduler::sessionEnded);
+    }
+
+    static QString downloadDir() {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/downloads";
+    }
+
+    bool isRunning() const { return running; }
+
+    void start(const QList<Action>& actions, const QString& prefetched = QString(),
+               const QString& offlineRepo = QString(), InstallJournal* installJournal = nullptr) {
+        if (running) return;
+        plan = actions;
+        journal = installJournal;
+        state.clear();
+        doneCount = 0;
+        for (const Action& a : plan) {
+            if (journal && journal->isDone(a.id)) {
+                state[a.id] = Done;
+                ++doneCount;
+                emit logLine("Already done " + a.id);
+            } else {
+                state[a.id] = Pending;
+            }
+        }
+        firstError.clear();
+        lockBusy = false;
+        running = true;
+        repo = offlineRepo;
+        QDir().mkpath(downloadDir());
+        engine->startSession(prefetched, repo);
+        schedule();
+    }
+
+signals:
+    void progressChanged(int percent, const QString& text);
+    void logLine(const QString& line);
+    void actionFinished(const QString& id, bool ok);
+    void finished(bool ok, const QString& error);
+
+private:
+    enum State { Pending, Running, Done, Failed, Skipped };
+
+    void schedule() {
+        if (!running) return;
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (const Action& a : plan) {
+                if (state[a.id] != Pending) continue;
+                bool ready = true;
+                bool blocked = false;
+                for (const QString& dep : a.after) {
+                    State s = state.value(dep, Failed);
+                    if (s == Failed || s == Skipped) blocked = true;
+                    if (s != Done) ready = false;
+                }
+                if (blocked) {
+                    state[a.id] = Skipped;
+                    emit logLine("Skipped " + a.id);
+                    changed = true;
+                } else if (ready && !a.needsLock()) {
+                    state[a.id] = Running;
+                    fetch(a);
+                } else if (ready && !lockBusy) {
+                    state[a.id] = Running;
+                    lockBusy = true;
+                    lockAction = a.id;
+                    emit logLine("Running " + a.id);
+                    engine->run(a.id, a.command(downloadDir()));
+                }
+            }
+        }
+
+        for (const Action& a : plan) {
+            if (state[a.id] == Running) return;
+        }
+        // Nothing runs and nothing can start: either done or stuck on a cycle.
+        for (const Action& a : plan) {
+            if (state[a.id] == Pending) {
+                state[a.id] = Skipped;
+                if (firstError.isEmpty()) firstError = "Unresolvable action dependencies at " + a.id;
+            }
+        }
+        engine->endSession();
+    }
+
+    void complete(const QString& id, bool ok, const QString& error) {
+        if (!running || state.value(id) != Running) return;
+        state[id] = ok ? Done : Failed;
+        if (ok && journal) journal->markDone(id);
+        if (ok) ++doneCount;
+        else if (firstError.isEmpty()) firstError = error;
+        emit actionFinished(id, ok);
+        schedule();
+    }
+
+    void fetch(const Action& a) {
+        const QString id = a.id;
+        const QString local = OfflineRepo::fileFor(repo, a.args.value(1));
+        if (!repo.isEmpty() && QFile::exists(local)) {
+            const QString target = downloadDir() + "/" + a.args.value(1);
+            QFile::remove(target);
+            const bool ok = QFile::copy(local, target);
+            emit logLine("Copying " + local);
+            QMetaObject::invokeMethod(this, [this, id, ok, local]() {
+                complete(id, ok, "Cannot copy " + local);
+            }, Qt::QueuedConnection);
+            return;
+        }
+        auto* out = new QSaveFile(downloadDir() + "/" + a.args.value(1), this);
+        if (!out->open(QIODevice::WriteOnly)) {
+            delete out;
+            QMetaObject::invokeMethod(this, [this, id, a]() {
+                complete(id, false, "Cannot write " + a.args.value(1));
+            }, Qt::QueuedConnection);
+            return;
+        }
+        emit logLine("Downloading " + a.args.value(0));
+        QNetworkReply* reply = nam.get(QNetworkRequest(QUrl(a.args.value(0))));
+        replies << reply;
+        connect(reply, &QNetworkReply::readyRead, out, [reply, out]() { out->write(reply->readAll()); });
+        connect(reply, &QNetworkReply::finished, this, [this, reply, out, id]() {
+            replies.removeOne(reply);
+            reply->deleteLater();
+            out->write(reply->readAll());
+            bool ok = reply->error() == QNetworkReply::NoError && out->commit();
+            if (!ok) out->cancelWriting();
+            QString error = reply->errorString();
+            out->deleteLater();
+            complete(id, ok, id + ": " + error);
+        });
+    }
+
+    void sessionEnded(bool ok, const QString& error) {
+        if (!running) return;
+        running = false;
+        const QList<QNetworkReply*> pending = replies;
+        replies.clear();
+        for (QNetworkReply* reply : pending) reply->abort();
+        bool allDone = ok;
+        for (const Action& a : plan) {
+            if (state[a.id] != Done) allDone = false;
+        }
+        if (allDone) {
+            QDir(downloadDir()).removeRecursively();
+            if (journal) journal->finish();
+        }
+        emit finished(allDone, firstError.isEmpty() ? error : firstError);
+    }
+
+    InstallEngine* engine;
+    QNetworkAccessManager nam;
+    QList<QNetworkReply*> replies;
+    QList<Action> plan;
+    QString repo;
+    InstallJournal* journal = nullptr;
+    QHash<QString, State> state;
+    QString firstError;
+    int doneCount = 0;
+    bool lockBusy = false;
+    QString lockAction;
+    bool running = false;
+};
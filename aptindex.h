@@ -0,0 +1,331 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QSysInfo>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <sys/statvfs.h>
+
+#include "trace.h"
+
+struct PackageSize {
+    quint64 download = 0;
+    quint64 installed = 0;
+};
+
+// Every package of the native or 'all' architecture in apt's package
+// lists, with its sizes and its Depends/Pre-Depends edges resolved to
+// package ids (first alternative apt knows, virtual names through
+// Provides). The lists are mapped and scanned without copying, and the
+// resulting graph is cached in a flat binary file until a list changes.
+class AptIndex {
+public:
+    // extraLists: further Packages files, e.g. an offline repository's.
+    static AptIndex load(const QStringList& extraLists = {}) {
+        TRACE_SCOPE("AptIndex::load");
+        const QStringList lists = listFiles() + extraLists;
+        const quint64 fp = fingerprint(lists);
+        const QString cachePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/aptindex.cache";
+
+        AptIndex index;
+        if (index.loadCache(cachePath, fp)) return index;
+        index.build(lists);
+        index.writeCache(cachePath, fp);
+        return index;
+    }
+
+    int count() const { return int(sizes.size()); }
+    int id(const QString& pkg) const { return ids.value(pkg.toUtf8(), -1); }
+    QString name(int id) const {
+        return QString::fromUtf8(names.constData() + nameStart[id], nameStart[id + 1] - nameStart[id]);
+    }
+
+    bool contains(const QString& pkg) const { return id(pkg) >= 0; }
+    PackageSize size(int id) const { return sizes[id]; }
+    PackageSize size(const QString& pkg) const {
+        const int i = id(pkg);
+        return i < 0 ? PackageSize() : sizes[i];
+    }
+
+    // Resolved dependencies of a package as [depsBegin, depsEnd).
+    const quint32* depsBegin(int id) const { return edges.data() + edgeStart[id]; }
+    const quint32* depsEnd(int id) const { return edges.data() + edgeStart[id + 1]; }
+
+    static quint64 freeSpace(const QString& path = "/") {
+        struct statvfs st;
+        if (statvfs(QFile::encodeName(path).constData(), &st) != 0) return 0;
+        return quint64(st.f_bavail) * st.f_frsize;
+    }
+
+    static QString nativeArch() {
+        const QString cpu = QSysInfo::buildCpuArchitecture();
+        if (cpu == "x86_64") return "amd64";
+        if (cpu == "arm") return "armhf";
+        if (cpu == "power64") return "ppc64el";
+        return cpu;
+    }
+
+private:
+    static QStringList listFiles() {
+        QStringList files;
+        const QDir dir("/var/lib/apt/lists");
+        for (const QString& name : dir.entryList({"*_Packages"}, QDir::Files, QDir::Name)) {
+            files << dir.filePath(name);
+        }
+        return files;
+    }
+
+    static quint64 fingerprint(const QStringList& lists) {
+        quint64 h = 14695981039346656037ull;
+        auto mix = [&h](const void* data, size_t len) {
+            auto* p = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < len; ++i) h = (h ^ p[i]) * 1099511628211ull;
+        };
+        for (const QString& file : lists) {
+            QFileInfo fi(file);
+            qint64 stamp[2] = {fi.lastModified().toMSecsSinceEpoch(), fi.size()};
+            mix(file.constData(), file.size() * sizeof(QChar));
+            mix(stamp, sizeof(stamp));
+        }
+        return h;
+    }
+
+    static quint64 toNumber(const char* p, const char* end) {
+        quint64 v = 0;
+        while (p < end && *p == ' ') ++p;
+        while (p < end && *p >= '0' && *p <= '9') v = v * 10 + (*p++ - '0');
+        return v;
+    }
+
+    struct Field {
+        const char* begin = nullptr;
+        const char* end = nullptr;
+    };
+
+    // Raw dependency fields of package n; they point into the mapped lists,
+    // which stay mapped until build() has resolved every edge.
+    struct Stanza {
+        Field depends;
+        Field preDepends;
+    };
+
+    void build(const QStringList& lists) {
+        TRACE_SCOPE("AptIndex::build");
+        std::vector<std::unique_ptr<QFile>> files;
+        std::vector<Stanza> stanzas;
+        QHash<QByteArray, int> providers;
+        for (const QString& path : lists) {
+            auto f = std::make_unique<QFile>(path);
+            if (!f->open(QIODevice::ReadOnly) || f->size() == 0) continue;
+            const char* data = reinterpret_cast<const char*>(f->map(0, f->size()));
+            if (!data) continue;
+            scan(data, data + f->size(), stanzas, providers);
+            files.push_back(std::move(f));
+        }
+        nameStart.push_back(quint32(names.size()));
+
+        // Providers are only known once every list is scanned.
+        edgeStart.assign(1, 0);
+        for (const Stanza& s : stanzas) {
+            const int self = int(edgeStart.size() - 1);
+            const size_t first = edges.size();
+            for (const Field& field : {s.preDepends, s.depends}) {
+                for (const char* p = field.begin; p && p < field.end;) {
+                    const char* comma = std::find(p, field.end, ',');
+                    const int dep = resolveGroup(p, comma, providers);
+                    if (dep >= 0 && dep != self
+                        && std::find(edges.begin() + first, edges.end(), quint32(dep)) == edges.end()) {
+                        edges.push_back(quint32(dep));
+                    }
+                    p = comma + 1;
+                }
+            }
+            edgeStart.push_back(quint32(edges.size()));
+        }
+    }
+
+    // "a (>= 1) | b:any | c" -> id of the first alternative that exists.
+    int resolveGroup(const char* p, const char* end, const QHash<QByteArray, int>& providers) const {
+        while (p < end) {
+            const char* bar = std::find(p, end, '|');
+            while (p < bar && *p == ' ') ++p;
+            const char* e = p;
+            while (e < bar && *e != ' ' && *e != '(' && *e != ':') ++e;
+            const QByteArray name = QByteArray::fromRawData(p, e - p);
+            int id = ids.value(name, -1);
+            if (id < 0) id = providers.value(name, -1);
+            if (id >= 0) return id;
+            p = bar + 1;
+        }
+        return -1;
+    }
+
+    // First stanza of a name wins, like the first list in apt's order.
+    void scan(const char* data, const char* end, std::vector<Stanza>& stanzas, QHash<QByteArray, int>& providers) {
+        const QByteArray arch = nativeArch().toUtf8();
+        Field name, provides;
+        Stanza stanza;
+        bool archOk = true;
+        PackageSize size;
+        auto flush = [&]() {
+            if (name.begin && archOk) {
+                const QByteArray key(name.begin, name.end - name.begin);
+                if (!ids.contains(key)) {
+                    const int id = int(sizes.size());
+                    ids.insert(key, id);
+                    sizes.push_back(size);
+                    stanzas.push_back(stanza);
+                    nameStart.push_back(quint32(names.size()));
+                    names.append(key);
+                    for (const char* p = provides.begin; p && p < provides.end;) {
+                        const char* comma = std::find(p, provides.end, ',');
+                        while (p < comma && *p == ' ') ++p;
+                        const char* e = p;
+                        while (e < comma && *e != ' ' && *e != '(') ++e;
+                        const QByteArray virt(p, e - p);
+                        if (!virt.isEmpty() && !providers.contains(virt)) providers.insert(virt, id);
+                        p = comma + 1;
+                    }
+                }
+            }
+            name = provides = Field();
+            stanza = Stanza();
+            archOk = true;
+            size = PackageSize();
+        };
+        auto value = [](const char* line, qsizetype skip, const char* eol) {
+            const char* b = line + skip;
+            const char* e = eol;
+            while (b < e && *b == ' ') ++b;
+            while (e > b && (e[-1] == ' ' || e[-1] == '\r')) --e;
+            return Field{b, e};
+        };
+
+        for (const char* line = data; line < end;) {
+            const char* eol = static_cast<const char*>(std::memchr(line, '\n', end - line));
+            if (!eol) eol = end;
+            const qsizetype len = eol - line;
+            if (len == 0) {
+                flush();
+            } else if (len > 9 && std::memcmp(line, "Package: ", 9) == 0) {
+                name = value(line, 9, eol);
+            } else if (len > 6 && std::memcmp(line, "Size: ", 6) == 0) {
+                size.download = toNumber(line + 6, eol);
+            } else if (len > 16 && std::memcmp(line, "Installed-Size: ", 16) == 0) {
+                size.installed = toNumber(line + 16, eol) * 1024;
+            } else if (len > 14 && std::memcmp(line, "Architecture: ", 14) == 0) {
+                const Field a = value(line, 14, eol);
+                const QByteArray v = QByteArray::fromRawData(a.begin, a.end - a.begin);
+                archOk = v == arch || v == "all";
+            } else if (len > 9 && std::memcmp(line, "Depends: ", 9) == 0) {
+                stanza.depends = value(line, 9, eol);
+            } else if (len > 13 && std::memcmp(line, "Pre-Depends: ", 13) == 0) {
+                stanza.preDepends = value(line, 13, eol);
+            } else if (len > 10 && std::memcmp(line, "Provides: ", 10) == 0) {
+                provides = value(line, 10, eol);
+            }
+            line = eol + 1;
+        }
+        flush();
+    }
+
+    // Followed by flat arrays: sizes, edgeStart, edges, nameStart, names.
+    struct CacheHeader {
+        char magic[8];
+        quint32 version;
+        quint32 count;
+        quint64 fingerprint;
+        quint32 edgeCount;
+        quint32 nameBytes;
+    };
+
+    bool loadCache(const QString& path, quint64 fp) {
+        TRACE_SCOPE("AptIndex::loadCache");
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly) || f.size() < qint64(sizeof(CacheHeader))) return false;
+        const uchar* data = f.map(0, f.size());
+        if (!data) return false;
+        CacheHeader h;
+        std::memcpy(&h, data, sizeof(h));
+        if (std::memcmp(h.magic, "ONCEDEPS", 8) != 0 || h.version != 1 || h.fingerprint != fp) return false;
+        const qint64 expected = qint64(sizeof(h)) + qint64(h.count) * qint64(sizeof(PackageSize))
+                                + 2 * (qint64(h.count) + 1) * 4 + qint64(h.edgeCount) * 4 + h.nameBytes;
+        if (f.size() != expected) return false;
+
+        const uchar* p = data + sizeof(h);
+        auto take = [&p](auto& vec, qsizetype n) {
+            vec.resize(n);
+            std::memcpy(vec.data(), p, n * sizeof(vec[0]));
+            p += n * sizeof(vec[0]);
+        };
+        take(sizes, h.count);
+        take(edgeStart, h.count + 1);
+        take(edges, h.edgeCount);
+        take(nameStart, h.count + 1);
+        names = QByteArray(reinterpret_cast<const char*>(p), h.nameBytes);
+        if (!validGraph()) {
+            *this = AptIndex();
+            return false;
+        }
+        ids.reserve(h.count);
+        for (quint32 i = 0; i < h.count; ++i) {
+            ids.insert(QByteArray(names.constData() + nameStart[i], nameStart[i + 1] - nameStart[i]), int(i));
+        }
+        return true;
+    }
+
+    // Offsets must start at zero, never decrease and end at the table they
+    // index, and every edge must name a package, so a corrupt cache whose
+    // fingerprint still matches is rebuilt instead of read out of bounds.
+    bool validGraph() const {
+        auto ranges = [](const std::vector<quint32>& starts, quint64 total) {
+            if (starts.front() != 0 || starts.back() != total) return false;
+            return std::is_sorted(starts.begin(), starts.end());
+        };
+        if (!ranges(edgeStart, edges.size()) || !ranges(nameStart, quint64(names.size()))) return false;
+        const quint32 n = quint32(sizes.size());
+        return std::all_of(edges.begin(), edges.end(), [n](quint32 dep) { return dep < n; });
+    }
+
+    void writeCache(const QString& path, quint64 fp) const {
+        CacheHeader h{};
+        std::memcpy(h.magic, "ONCEDEPS", 8);
+        h.version = 1;
+        h.count = quint32(sizes.size());
+        h.fingerprint = fp;
+        h.edgeCount = quint32(edges.size());
+        h.nameBytes = quint32(names.size());
+        QByteArray out;
+        auto put = [&out](const void* data, size_t bytes) { out.append(static_cast<const char*>(data), bytes); };
+        put(&h, sizeof(h));
+        put(sizes.data(), sizes.size() * sizeof(PackageSize));
+        put(edgeStart.data(), edgeStart.size() * 4);
+        put(edges.data(), edges.size() * 4);
+        put(nameStart.data(), nameStart.size() * 4);
+        put(names.constData(), names.size());
+
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) return;
+        file.write(out);
+        file.commit();
+    }
+
+    QHash<QByteArray, int> ids;
+    std::vector<PackageSize> sizes;
+    std::vector<quint32> edgeStart = {0};
+    std::vector<quint32> edges;
+    std::vector<quint32> nameStart;
+    QByteArray names;
+};
@@ -0,0 +1,134 @@
+// Benchmarks for the wizard's hot paths on the offscreen platform, so the
+// numbers do not depend on a display server:
+//   once_bench                  all benchmarks
+//   once_bench -iterations 50   more stable numbers
+//   once_bench -csv             for comparing releases
+
+#include <QApplication>
+#include <QImage>
+#include <QPixmap>
+#include <QtTest>
+
+#include "licenseviewer.h"
+#include "onboardingtour.h"
+#include "revealview.h"
+#include "theme.h"
+
+class OnboardingTourBench : public QObject {
+    Q_OBJECT
+
+private slots:
+    void construction() {
+        QBENCHMARK {
+            OnboardingTour tour;
+        }
+    }
+
+    // Toggles every profile and rebuilds the preview, the same work one
+    // frame does after a burst of clicks.
+    void updateCommandAllProfiles() {
+        OnboardingTour tour;
+        tour.showStep(3);
+        const QStringList ids = tour.profiles.keys();
+        QVERIFY(!ids.isEmpty());
+        QBENCHMARK {
+            for (const QString& id : ids) tour.toggleProfile(id, !tour.selected.contains(id));
+            tour.flushCommand();
+        }
+    }
+
+    // Types a query one key at a time over a catalog of a few thousand
+    // generated profiles, then clears it again.
+    void catalogSearch() {
+        QMap<QString, Profile> profiles;
+        for (int i = 0; i < 5000; ++i) {
+            Profile p;
+            p.name = QString("Profile %1").arg(i);
+            p.desc = QString("Generated entry number %1 for the search benchmark").arg(i);
+            p.apps = {QString("package-%1").arg(i), QString("lib%1-common").arg(i % 97), "fonts-noto"};
+            profiles.insert(QString("p%1").arg(i), p);
+        }
+        const QSet<QString> selected;
+        const auto none = [](const QString&) { return QString(); };
+        CatalogModel model(profiles, selected, none, none);
+        const QString query = "lib42 comm";
+        QBENCHMARK {
+            for (qsizetype n = 1; n <= query.size(); ++n) model.setFilter(query.left(n));
+            model.setFilter(QString());
+        }
+    }
+
+    // Lays out the whole license, reveals it and paints it once.
+    void licenseReveal() {
+        QBENCHMARK {
+            LicenseViewer viewer;
+            viewer.textView->revealAll();
+            QPixmap frame(viewer.size());
+            viewer.render(&frame);
+        }
+    }
+
+    // A check rather than a benchmark: each paragraph is drawn on its own
+    // line, not on top of the first one.
+    void revealLaterParagraph() {
+        RevealView view;
+        view.setAnimated(false);
+        view.resize(300, 200);
+        view.setText("AAAAAAAA\nBBBBBBBB");
+        view.revealAll();
+        QImage frame(view.size(), QImage::Format_ARGB32);
+        view.render(&frame);
+
+        const QRgb background = frame.pixel(frame.width() / 2, frame.height() - 10);
+        const int h = view.fontMetrics().height();
+        auto inked = [&](int top) {
+            for (int y = top; y < top + h; ++y) {
+                for (int x = 0; x < frame.width() / 2; ++x) {
+                    if (frame.pixel(x, y) != background) return true;
+                }
+            }
+            return false;
+        };
+        const int margin = 4;
+        QVERIFY(inked(margin));
+        QVERIFY(inked(margin + h));
+    }
+
+    void paint_data() {
+        QTest::addColumn<QSize>("size");
+        QTest::newRow("1024x600") << QSize(1024, 600);
+        QTest::newRow("1366x768") << QSize(1366, 768);
+        QTest::newRow("1920x1080") << QSize(1920, 1080);
+        QTest::newRow("3840x2160") << QSize(3840, 2160);
+    }
+
+    void paint() {
+        QFETCH(QSize, size);
+        OnboardingTour tour;
+        tour.resize(size);
+        QPixmap frame(size);
+        frame.fill(Qt::transparent);
+        QBENCHMARK {
+            tour.render(&frame);
+        }
+    }
+
+    void showStepTransitions() {
+        OnboardingTour tour;
+        for (int s = 0; s < 5; ++s) tour.ensureStep(s);
+        QBENCHMARK {
+            for (int s = 0; s < 5; ++s) tour.showStep(s);
+            for (int s = 4; s >= 0; --s) tour.showStep(s);
+        }
+    }
+};
+
+int main(int argc, char** argv) {
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    Theme::apply(app);
+    OnboardingTourBench bench;
+    return QTest::qExec(&bench, argc, argv);
+}
+
+#include "once_bench.moc"
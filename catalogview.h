@@ -0,0 +1,374 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QApplication>
+#include <QEvent>
+#include <QHash>
+#include <QKeyEvent>
+#include <QListView>
+#include <QMap>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPainterPath>
+#include <QSet>
+#include <QStyle>
+#include <QStyleOptionButton>
+#include <QStyledItemDelegate>
+#include <QStringList>
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "iconcache.h"
+#include "profilecatalog.h"
+#include "trace.h"
+
+// Search over profile names, descriptions and package names. Every field
+// is split into lower-case words kept in one sorted list, so a query word
+// is looked up as a prefix with a binary search. A query word that is no
+// word's prefix may still match a profile name fuzzily (its letters in
+// order). Each query narrows the previous result when it extends the
+// previous query, so typing only ever re-checks what still matches.
+class CatalogSearch {
+public:
+    void build(const QStringList& ids, const QMap<QString, Profile>& profiles) {
+        TRACE_SCOPE("CatalogSearch::build");
+        words.clear();
+        names.clear();
+        for (int i = 0; i < ids.size(); ++i) {
+            const Profile& p = profiles.constFind(ids[i]).value();
+            names << p.name.toLower();
+            for (const QString& w : split(p.name)) words.push_back({w, i, NameWeight});
+            for (const QString& w : split(p.desc)) words.push_back({w, i, DescWeight});
+            for (const QString& app : p.apps) {
+                words.push_back({app.toLower(), i, PackageWeight});
+                for (const QString& w : split(app)) words.push_back({w, i, PackageWeight});
+            }
+        }
+        std::sort(words.begin(), words.end(), [](const Word& a, const Word& b) { return a.text < b.text; });
+        last = QString();
+        result.resize(ids.size());
+        for (int i = 0; i < ids.size(); ++i) result[i] = i;
+        all = result;
+    }
+
+    // Indices into the ids given to build(), best matches first.
+    const std::vector<int>& match(const QString& query) {
+        TRACE_SCOPE("CatalogSearch::match");
+        const QString q = query.toLower();
+        const QStringList terms = split(q);
+        if (terms.isEmpty()) {
+            result = all;
+        } else {
+            const bool narrowing = !last.isEmpty() && q.startsWith(last);
+            std::vector<int> candidates = narrowing ? result : all;
+            std::vector<int> score(names.size(), 0);
+            std::vector<quint8> best(names.size());
+            for (const QString& term : terms) {
+                std::fill(best.begin(), best.end(), 0);
+                auto it = std::lower_bound(words.cbegin(), words.cend(), term,
+                                           [](const Word& w, const QString& t) { return w.text < t; });
+                for (; it != words.cend() && it->text.startsWith(term); ++it) {
+                    best[it->profile] = std::max(best[it->profile], it->weight);
+                }
+                auto keep = candidates.begin();
+                for (int c : candidates) {
+                    if (best[c] == 0 && fuzzy(term, names[c])) best[c] = FuzzyWeight;
+                    if (best[c] == 0) continue;
+                    score[c] += best[c];
+                    *keep++ = c;
+                }
+                candidates.erase(keep, candidates.end());
+            }
+            std::sort(candidates.begin(), candidates.end(), [&score](int a, int b) {
+                return score[a] != score[b] ? score[a] > score[b] : a < b;
+            });
+            result = std::move(candidates);
+        }
+        last = q;
+        return result;
+    }
+
+private:
+    enum Weight : quint8 { FuzzyWeight = 1, DescWeight = 2, PackageWeight = 3, NameWeight = 4 };
+
+    struct Word {
+        QString text;
+        int profile;
+        quint8 weight;
+    };
+
+    static QStringList split(const QString& text) {
+        QStringList out;
+        qsizetype start = -1;
+        for (qsizetype i = 0; i <= text.size(); ++i) {
+            const bool inWord = i < text.size() && text[i].isLetterOrNumber();
+            if (inWord && start < 0) start = i;
+            if (!inWord && start >= 0) {
+                out << text.mid(start, i - start).toLower();
+                start = -1;
+            }
+        }
+        return out;
+    }
+
+    static bool fuzzy(const QString& term, const QString& name) {
+        qsizetype j = 0;
+        for (qsizetype i = 0; i < name.size() && j < term.size(); ++i) {
+            if (name[i] == term[j]) ++j;
+        }
+        return j == term.size();
+    }
+
+    std::vector<Word> words;
+    QStringList names;
+    std::vector<int> all;
+    std::vector<int> result;
+    QString last;
+};
+
+// The profile catalog as a flat list model, filtered by a CatalogSearch.
+// Selection stays with the owner: checking a row only emits toggled(), and
+// the owner calls refresh() once its state has changed. Titles and details
+// are computed only for rows a view asks for, and kept until refresh().
+class CatalogModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    enum Role { IdRole = Qt::UserRole, DetailsRole, DetailLinesRole, IconRole };
+
+    using TextFor = std::function<QString(const QString& id)>;
+
+    CatalogModel(const QMap<QString, Profile>& profiles, const QSet<QString>& selected, TextFor title,
+                 TextFor details, QObject* parent = nullptr)
+        : QAbstractListModel(parent), profiles(profiles), selected(selected), titleFor(std::move(title)),
+          detailsFor(std::move(details)) {
+        ids = profiles.keys();
+        search.build(ids, profiles);
+        rows = search.match(QString());
+    }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : int(rows.size());
+    }
+
+    QVariant data(const QModelIndex& index, int role) const override {
+        if (!index.isValid() || index.row() >= int(rows.size())) return QVariant();
+        const int i = rows[index.row()];
+        const QString& id = ids[i];
+        switch (role) {
+        case Qt::DisplayRole: return cached(titles, i, titleFor);
+        case Qt::CheckStateRole: return int(selected.contains(id) ? Qt::Checked : Qt::Unchecked);
+        case IdRole: return id;
+        case DetailsRole: return cached(details, i, detailsFor);
+        case DetailLinesRole: {
+            const Profile& p = profiles.constFind(id).value();
+            return int(p.apps.size() + p.actions.size());
+        }
+        case IconRole: return profiles.constFind(id)->icon;
+        }
+        return QVariant();
+    }
+
+    bool setData(const QModelIndex& index, const QVariant& value, int role) override {
+        if (role != Qt::CheckStateRole || !index.isValid()) return false;
+        emit toggled(ids[rows[index.row()]], value.toInt() == Qt::Checked);
+        return true;
+    }
+
+    Qt::ItemFlags flags(const QModelIndex& index) const override {
+        return index.isValid() ? Qt::ItemIsEnabled | Qt::ItemIsUserCheckable : Qt::NoItemFlags;
+    }
+
+    // Rows to show: the profiles matching query, best first.
+    void setFilter(const QString& query) {
+        beginResetModel();
+        rows = search.match(query);
+        endResetModel();
+    }
+
+    // Titles, details and checked rows (and with them row heights) may all
+    // have changed.
+    void refresh() {
+        titles.clear();
+        details.clear();
+        emit layoutAboutToBeChanged();
+        emit layoutChanged();
+    }
+
+signals:
+    void toggled(const QString& id, bool checked);
+
+private:
+    QString cached(QHash<int, QString>& cache, int i, const TextFor& make) const {
+        auto it = cache.constFind(i);
+        if (it == cache.cend()) it = cache.insert(i, make(ids[i]));
+        return *it;
+    }
+
+    const QMap<QString, Profile>& profiles;
+    const QSet<QString>& selected;
+    TextFor titleFor;
+    TextFor detailsFor;
+    QStringList ids;
+    std::vector<int> rows;
+    CatalogSearch search;
+    mutable QHash<int, QString> titles;
+    mutable QHash<int, QString> details;
+};
+
+// Paints one catalog row as a card: check box, icon and title, plus the
+// profile's packages and actions below while it is checked. Row heights
+// come from line counts alone, so laying out thousands of rows never
+// formats their text; only visible rows are painted.
+class CatalogDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+public:
+    using QStyledItemDelegate::QStyledItemDelegate;
+
+    struct Colors {
+        QColor card{40, 40, 60, 200};
+        QColor title = Qt::white;
+        QColor details{20, 20, 30, 180};
+        QColor detailsText{160, 160, 192};
+    };
+    Colors colors;
+
+    void paint(QPainter* p, const QStyleOptionViewItem& option, const QModelIndex& index) const override {
+        TRACE_SCOPE("CatalogDelegate::paint");
+        p->save();
+        p->setRenderHint(QPainter::Antialiasing);
+        const QRect card = option.rect.adjusted(0, 0, 0, -spacing);
+        QPainterPath cardPath;
+        cardPath.addRoundedRect(card, 10, 10);
+        p->fillPath(cardPath, colors.card);
+
+        const QWidget* w = option.widget;
+        QStyle* style = w ? w->style() : QApplication::style();
+        const QFont title = titleFont(option.font);
+        const int header = headerHeight(option.font);
+
+        const int side = style->pixelMetric(QStyle::PM_IndicatorWidth, nullptr, w);
+        QStyleOptionButton box;
+        box.rect = QRect(card.left() + padding, card.top() + padding + (header - side) / 2, side, side);
+        box.state = QStyle::State_Enabled | (expanded(index) ? QStyle::State_On : QStyle::State_Off);
+        if (option.state & QStyle::State_HasFocus) box.state |= QStyle::State_HasFocus;
+        style->drawPrimitive(QStyle::PE_IndicatorCheckBox, &box, p, w);
+
+        int x = box.rect.right() + padding;
+        const qreal dpr = w ? w->devicePixelRatioF() : 1.0;
+        const QPixmap icon = IconCache::instance()->pixmap(index.data(CatalogModel::IconRole).toString(), iconSize, dpr);
+        if (!icon.isNull()) p->drawPixmap(x, card.top() + padding + (header - iconSize) / 2, icon);
+        x += iconSize + padding;
+
+        p->setFont(title);
+        p->setPen(colors.title);
+        const QRect titleRect(x, card.top() + padding, card.right() - padding - x, header);
+        p->drawText(titleRect, Qt::AlignVCenter | Qt::AlignLeft,
+                    QFontMetrics(title).elidedText(index.data().toString(), Qt::ElideRight, titleRect.width()));
+
+        if (expanded(index)) {
+            const QFont font = detailsFont(option.font);
+            const QFontMetrics fm(font);
+            const QRect box(card.left() + padding + indent, card.top() + 2 * padding + header,
+                            card.width() - 2 * padding - indent, detailsHeight(option.font, index));
+            QPainterPath boxPath;
+            boxPath.addRoundedRect(box, 6, 6);
+            p->fillPath(boxPath, colors.details);
+            p->setFont(font);
+            p->setPen(colors.detailsText);
+            int y = box.top() + detailsPadding;
+            const int width = box.width() - 2 * detailsPadding;
+            for (const QString& line : index.data(CatalogModel::DetailsRole).toString().split('\n', Qt::SkipEmptyParts)) {
+                p->drawText(box.left() + detailsPadding, y + fm.ascent(), fm.elidedText(line, Qt::ElideRight, width));
+                y += fm.height();
+            }
+        }
+        p->restore();
+    }
+
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override {
+        int h = 2 * padding + headerHeight(option.font) + spacing;
+        if (expanded(index)) h += padding + detailsHeight(option.font, index);
+        return QSize(option.rect.width(), h);
+    }
+
+    // A click anywhere on the card or space on the current row toggles it.
+    bool editorEvent(QEvent* event, QAbstractItemModel* model, const QStyleOptionViewItem&,
+                     const QModelIndex& index) override {
+        bool toggle = false;
+        if (event->type() == QEvent::MouseButtonRelease) {
+            toggle = static_cast<QMouseEvent*>(event)->button() == Qt::LeftButton;
+        } else if (event->type() == QEvent::KeyPress) {
+            const int key = static_cast<QKeyEvent*>(event)->key();
+            toggle = key == Qt::Key_Space || key == Qt::Key_Select;
+        }
+        if (!toggle) return false;
+        return model->setData(index, int(expanded(index) ? Qt::Unchecked : Qt::Checked), Qt::CheckStateRole);
+    }
+
+private:
+    static constexpr int padding = 12;
+    static constexpr int spacing = 10;
+    static constexpr int indent = 30;
+    static constexpr int detailsPadding = 10;
+    static constexpr int iconSize = 24;
+
+    static bool expanded(const QModelIndex& index) {
+        return index.data(Qt::CheckStateRole).toInt() == Qt::Checked;
+    }
+
+    static QFont titleFont(QFont f) {
+        f.setPixelSize(15);
+        f.setBold(true);
+        return f;
+    }
+
+    static QFont detailsFont(QFont f) {
+        f.setPixelSize(12);
+        return f;
+    }
+
+    static int headerHeight(const QFont& base) {
+        return std::max(iconSize, QFontMetrics(titleFont(base)).height());
+    }
+
+    static int detailsHeight(const QFont& base, const QModelIndex& index) {
+        const int lines = index.data(CatalogModel::DetailLinesRole).toInt();
+        return 2 * detailsPadding + lines * QFontMetrics(detailsFont(base)).height();
+    }
+};
+
+// List view for the catalog. Rows are laid out in batches and scrolled by
+// pixel; the card colors come from the theme through qproperty-*.
+class CatalogView : public QListView {
+    Q_OBJECT
+    Q_PROPERTY(QColor cardColor READ cardColor WRITE setCardColor)
+    Q_PROPERTY(QColor titleColor READ titleColor WRITE setTitleColor)
+    Q_PROPERTY(QColor detailsColor READ detailsColor WRITE setDetailsColor)
+    Q_PROPERTY(QColor detailsTextColor READ detailsTextColor WRITE setDetailsTextColor)
+public:
+    explicit CatalogView(QWidget* parent = nullptr) : QListView(parent) {
+        delegate = new CatalogDelegate(this);
+        setItemDelegate(delegate);
+        setSelectionMode(NoSelection);
+        setVerticalScrollMode(ScrollPerPixel);
+        setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+        setUniformItemSizes(false);
+        setLayoutMode(Batched);
+        setBatchSize(256);
+        connect(IconCache::instance(), &IconCache::iconReady, viewport(), qOverload<>(&QWidget::update));
+    }
+
+    QColor cardColor() const { return delegate->colors.card; }
+    void setCardColor(const QColor& c) { delegate->colors.card = c; }
+    QColor titleColor() const { return delegate->colors.title; }
+    void setTitleColor(const QColor& c) { delegate->colors.title = c; }
+    QColor detailsColor() const { return delegate->colors.details; }
+    void setDetailsColor(const QColor& c) { delegate->colors.details = c; }
+    QColor detailsTextColor() const { return delegate->colors.detailsText; }
+    void setDetailsTextColor(const QColor& c) { delegate->colors.detailsText = c; }
+
+private:
+    CatalogDelegate* delegate;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QSet>
+#include <QSize>
+#include <QString>
+
+#include "trace.h"
+
+// How much rendering the device can afford, probed once at startup from
+// /proc, the screen and whether a compositor runs. Override with
+// --tier=low|medium|high or ONCE_TIER.
+//   low:    opaque window without mask, text appears at once, pages are
+//           built only when shown
+//   medium: translucent rounded window and animations, pages still lazy
+//   high:   everything, the next page is prebuilt in the background
+struct DeviceTier {
+    enum Level { Low, Medium, High };
+
+    Level level = High;
+    bool compositor = true;
+    quint64 memory = 0;
+    int cpus = 0;
+    QSize screen;
+
+    // Without a compositor a translucent window just shows garbage corners.
+    bool translucent() const { return compositor && level > Low; }
+    bool animated() const { return level > Low; }
+    bool prebuildPages() const { return level == High; }
+
+    static const DeviceTier& current() {
+        static const DeviceTier tier = probe();
+        return tier;
+    }
+
+    static QString name(Level level) {
+        switch (level) {
+        case Low: return "low";
+        case Medium: return "medium";
+        case High: break;
+        }
+        return "high";
+    }
+
+    static DeviceTier probe() {
+        TRACE_SCOPE("DeviceTier::probe");
+        DeviceTier t;
+        t.memory = memTotal();
+        t.cpus = cpuCount();
+        if (QScreen* s = QGuiApplication::primaryScreen()) t.screen = s->size() * s->devicePixelRatio();
+        t.compositor = compositorRunning();
+
+        const quint64 gib = 1024ull * 1024 * 1024;
+        if ((t.memory && t.memory < 2 * gib) || (t.cpus && t.cpus <= 2)) t.level = Low;
+        else if ((t.memory && t.memory < 4 * gib) || (t.cpus && t.cpus <= 4)) t.level = Medium;
+
+        QString forced = qEnvironmentVariable("ONCE_TIER");
+        for (const QString& arg : QCoreApplication::arguments()) {
+            if (arg.startsWith("--tier=")) forced = arg.mid(7);
+        }
+        bool overridden = true;
+        if (forced == "low") t.level = Low;
+        else if (forced == "medium") t.level = Medium;
+        else if (forced == "high") t.level = High;
+        else overridden = false;
+
+        qInfo("once: %s rendering tier%s (%llu MiB RAM, %d CPUs, %dx%d, %s)", qPrintable(name(t.level)),
+              overridden ? " (forced)" : "", t.memory / (1024 * 1024), t.cpus, t.screen.width(),
+              t.screen.height(), t.compositor ? "composited" : "no compositor");
+        return t;
+    }
+
+private:
+    static QByteArray readProc(const QString& path) {
+        // /proc files report a size of 0, so read until EOF.
+        QFile f(path);
+        return f.open(QIODevice::ReadOnly) ? f.readAll() : QByteArray();
+    }
+
+    static quint64 memTotal() {
+        const QByteArray info = readProc("/proc/meminfo");
+        const qsizetype at = info.indexOf("MemTotal:");
+        if (at < 0) return 0;
+        const qsizetype eol = info.indexOf('\n', at);
+        return info.mid(at + 9, eol - at - 9).replace("kB", "").trimmed().toULongLong() * 1024;
+    }
+
+    static int cpuCount() {
+        const QByteArray info = readProc("/proc/cpuinfo");
+        int n = 0;
+        for (qsizetype at = 0; (at = info.indexOf("\nprocessor", at)) >= 0; ++at) ++n;
+        if (info.startsWith("processor")) ++n;
+        return n;
+    }
+
+    // Wayland and the offscreen platform always composite. On X11 there is
+    // no portable query without talking to the server, so look for a
+    // running compositing manager.
+    static bool compositorRunning() {
+        if (QGuiApplication::platformName() != "xcb") return true;
+        static const QSet<QByteArray> compositors = {"picom", "compton", "xcompmgr", "kwin_x11", "kwin",
+                                                     "mutter", "gnome-shell", "muffin", "marco", "compiz"};
+        for (const QString& pid : QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+            if (!pid.front().isDigit()) continue;
+            const QByteArray comm = readProc("/proc/" + pid + "/comm").trimmed();
+            if (compositors.contains(comm)) return true;
+        }
+        return false;
+    }
+};
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QFile>
+#include <QSet>
+#include <QString>
+
+#include <cstring>
+
+#include "trace.h"
+
+// Installed packages from dpkg's status database, read in one mapped pass.
+class DpkgStatus {
+public:
+    static QSet<QString> installed(const QString& path = "/var/lib/dpkg/status") {
+        TRACE_SCOPE("DpkgStatus::installed");
+        QSet<QString> result;
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly) || f.size() == 0) return result;
+        const char* data = reinterpret_cast<const char*>(f.map(0, f.size()));
+        if (!data) return result;
+        const char* end = data + f.size();
+
+        const char* name = nullptr;
+        qsizetype nameLength = 0;
+        bool isInstalled = false;
+        auto flush = [&]() {
+            if (name && isInstalled) result.insert(QString::fromUtf8(name, nameLength));
+            name = nullptr;
+            isInstalled = false;
+        };
+
+        for (const char* line = data; line < end;) {
+            const char* eol = static_cast<const char*>(std::memchr(line, '\n', end - line));
+            if (!eol) eol = end;
+            const qsizetype len = eol - line;
+            if (len == 0) {
+                flush();
+            } else if (len > 9 && std::memcmp(line, "Package: ", 9) == 0) {
+                name = line + 9;
+                nameLength = len - 9;
+            } else if (len > 8 && std::memcmp(line, "Status: ", 8) == 0) {
+                // "Status: <want> <flag> <state>", only the state matters.
+                static const char state[] = " installed";
+                const qsizetype n = sizeof(state) - 1;
+                isInstalled = len >= n && std::memcmp(eol - n, state, n) == 0;
+            }
+            line = eol + 1;
+        }
+        flush();
+        return result;
+    }
+};
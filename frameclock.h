@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QGuiApplication>
+#include <QHash>
+#include <QPointer>
+#include <QScreen>
+#include <QTimer>
+
+#include <functional>
+
+#include "trace.h"
+
+// One timer for every animation in the app. It ticks at the primary
+// screen's refresh rate, advances all running animations in the same
+// wakeup with a shared frame time, and stops as soon as none is left.
+class FrameClock : public QObject {
+    Q_OBJECT
+public:
+    static FrameClock* instance() {
+        static QPointer<FrameClock> clock;
+        if (!clock) clock = new FrameClock(QCoreApplication::instance());
+        return clock;
+    }
+
+    // Milliseconds since the clock was created, the same for every
+    // animation advanced in one tick.
+    qint64 frameTime() const { return now; }
+
+    // Calls frame() on every tick until stop(client) or client is destroyed.
+    void start(QObject* client, std::function<void()> frame) {
+        if (!animations.contains(client)) {
+            connect(client, &QObject::destroyed, this, [this, client]() { stop(client); });
+        }
+        animations.insert(client, std::move(frame));
+        if (!timer.isActive()) {
+            now = elapsed.elapsed();
+            const QScreen* screen = QGuiApplication::primaryScreen();
+            const qreal hz = screen && screen->refreshRate() > 1 ? screen->refreshRate() : 60;
+            timer.start(std::max(1, qRound(1000 / hz)));
+        }
+    }
+
+    void stop(QObject* client) {
+        if (animations.remove(client)) disconnect(client, &QObject::destroyed, this, nullptr);
+        if (animations.isEmpty()) timer.stop();
+    }
+
+    bool isRunning(const QObject* client) const { return animations.contains(const_cast<QObject*>(client)); }
+
+    int wakeups() const { return ticks; }
+
+private:
+    explicit FrameClock(QObject* parent) : QObject(parent) {
+        elapsed.start();
+        timer.setTimerType(Qt::PreciseTimer);
+        connect(&timer, &QTimer::timeout, this, &FrameClock::tick);
+    }
+
+    void tick() {
+        TRACE_SCOPE("FrameClock::tick");
+        ++ticks;
+        now = elapsed.elapsed();
+        // Animations may stop themselves or others while being advanced.
+        const QList<QObject*> clients = animations.keys();
+        for (QObject* client : clients) {
+            auto it = animations.constFind(client);
+            if (it != animations.constEnd()) {
+                const std::function<void()> frame = it.value();
+                frame();
+            }
+        }
+    }
+
+    QTimer timer;
+    QElapsedTimer elapsed;
+    QHash<QObject*, std::function<void()>> animations;
+    qint64 now = 0;
+    int ticks = 0;
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QSet>
+
+#include <cstdio>
+
+#include "actionscheduler.h"
+#include "dpkgstatus.h"
+#include "installplan.h"
+#include "journal.h"
+#include "offlinerepo.h"
+#include "packageindex.h"
+#include "profilecatalog.h"
+
+// Unattended provisioning without a display server, e.g.
+//   once --profiles essential,dev --yes
+// Progress goes to stdout one record per line:
+//   plan:<action>:<command>, progress:<percent>:<text>, log:<text>,
+//   action:<action>:ok|failed, result:ok|failed[:<error>]
+class HeadlessRunner {
+public:
+    enum ExitCode { ExitOk = 0, ExitFailed = 1, ExitUsage = 2 };
+
+    static bool requested(int argc, char** argv) {
+        for (int i = 1; i < argc; ++i) {
+            const QByteArray arg(argv[i]);
+            if (arg == "--headless" || arg == "--list-profiles" || arg == "--profiles" || arg.startsWith("--profiles=")
+                || arg == "--build-repo" || arg.startsWith("--build-repo=")) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static int exec(QCoreApplication& app) {
+        QCommandLineParser parser;
+        parser.setApplicationDescription("error.os setup, unattended mode");
+        QCommandLineOption help({"h", "help"}, "Show this help.");
+        QCommandLineOption headless("headless", "Run without a display; uses the default profiles unless --profiles is given.");
+        QCommandLineOption profilesOption("profiles", "Comma separated profile ids to install.", "ids");
+        QCommandLineOption yes("yes", "Install; without it the plan is only printed.");
+        QCommandLineOption list("list-profiles", "Print the profile catalog and exit.");
+        QCommandLineOption buildRepo("build-repo", "Download the full package closure of the profiles into an "
+                                                   "offline repository in dir and exit.", "dir");
+        QCommandLineOption repoOption("repo", "Install from the offline repository in dir (or $ONCE_REPO); "
+                                              "its packages are not signature checked.", "dir");
+        parser.addOptions({help, headless, profilesOption, yes, list, buildRepo, repoOption});
+        if (!parser.parse(app.arguments())) {
+            print("result:failed:" + parser.errorText());
+            return ExitUsage;
+        }
+        if (parser.isSet(help)) {
+            std::fputs(qPrintable(parser.helpText()), stdout);
+            return ExitOk;
+        }
+
+        const QMap<QString, Profile> profiles = ProfileCatalog::load();
+        if (parser.isSet(list)) {
+            for (auto it = profiles.cbegin(); it != profiles.cend(); ++it) {
+                print("profile:" + it.key() + ":" + it->name + ":" + it->desc);
+            }
+            return ExitOk;
+        }
+
+        QSet<QString> selected;
+        PackageIndex index;
+        QStringList ids;
+        if (parser.isSet(profilesOption)) {
+            ids = parser.value(profilesOption).split(',', Qt::SkipEmptyParts);
+        } else {
+            for (auto it = profiles.cbegin(); it != profiles.cend(); ++it) {
+                if (it->preselected) ids << it.key();
+            }
+        }
+        for (const QString& raw : ids) {
+            const QString id = raw.trimmed();
+            if (!profiles.contains(id)) {
+                print("result:failed:unknown profile " + id);
+                return ExitUsage;
+            }
+            selected.insert(id);
+            index.addProfile(id, profiles[id].apps);
+        }
+
+        if (parser.isSet(buildRepo)) {
+            return buildOfflineRepo(parser.value(buildRepo), profiles, selected, index.packages());
+        }
+
+        const QList<Action> plan =
+            InstallPlan::build(profiles, selected, InstallPlan::missing(index.packages(), DpkgStatus::installed()));
+        for (const Action& a : plan) print("plan:" + a.id + ":" + a.preview());
+        if (!parser.isSet(yes) || InstallPlan::isEmpty(plan)) {
+            print("result:ok");
+            return ExitOk;
+        }
+
+        // Same file as the wizard's, so either one continues the other's
+        // interrupted install of the same profiles.
+        InstallJournal journal;
+        journal.load();
+        if (!journal.begin(selected, plan)) print("log:Cannot write " + InstallJournal::path());
+
+        ActionScheduler scheduler;
+        QObject::connect(&scheduler, &ActionScheduler::progressChanged, &app, [](int percent, const QString& text) {
+            print(QString("progress:%1:%2").arg(percent).arg(text));
+        });
+        QObject::connect(&scheduler, &ActionScheduler::logLine, &app, [](const QString& line) {
+            print("log:" + line);
+        });
+        QObject::connect(&scheduler, &ActionScheduler::actionFinished, &app, [](const QString& id, bool ok) {
+            print("action:" + id + (ok ? ":ok" : ":failed"));
+        });
+        QObject::connect(&scheduler, &ActionScheduler::finished, &app, [&app](bool ok, const QString& error) {
+            print(ok ? QString("result:ok") : "result:failed:" + error);
+            app.exit(ok ? ExitOk : ExitFailed);
+        }, Qt::QueuedConnection);
+        // Unattended runs never pick up a repository by themselves.
+        const QString repo = OfflineRepo::requested();
+        if (!repo.isEmpty() && !OfflineRepo::problem(repo).isEmpty()) {
+            print("result:failed:" + OfflineRepo::problem(repo));
+            return ExitUsage;
+        }
+        if (!repo.isEmpty()) print("log:Installing from the offline repository " + repo);
+        scheduler.start(plan, QString(), repo, &journal);
+        return app.exec();
+    }
+
+private:
+    // The target may start from a bare system, so every package of the
+    // selection goes in, installed here or not, plus what the profiles'
+    // own actions install or download.
+    static int buildOfflineRepo(const QString& dir, const QMap<QString, Profile>& profiles,
+                                const QSet<QString>& selected, QStringList packages) {
+        QList<Action> fetches;
+        for (const QString& id : selected) {
+            for (const Action& a : profiles[id].actions) {
+                if (a.kind == Action::FetchUrl) fetches << a;
+                if (a.kind != Action::AptInstall) continue;
+                for (const QString& arg : a.args) {
+                    if (!arg.startsWith('-')) packages << arg;
+                }
+            }
+        }
+        QString error;
+        const bool ok = OfflineRepo::build(QFileInfo(dir).absoluteFilePath(), packages, fetches,
+                                           [](const QString& line) { print("log:" + line); }, error);
+        print(ok ? QString("result:ok") : "result:failed:" + error);
+        return ok ? ExitOk : ExitFailed;
+    }
+
+    static void print(const QString& line) {
+        std::fputs(line.toUtf8().append('\n').constData(), stdout);
+        std::fflush(stdout);
+    }
+};
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <QObject>
+#include <QApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QIcon>
+#include <QImage>
+#include <QImageReader>
+#include <QLabel>
+#include <QPixmap>
+#include <QPointer>
+#include <QSaveFile>
+#include <QSet>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QThreadPool>
+
+#include <climits>
+
+#include "trace.h"
+
+// Themed icons resolved off the GUI thread. A label gets a transparent
+// placeholder of the final size right away and the icon once a worker has
+// found and rasterized it. Results are written to an on-disk cache keyed
+// by theme, name, size and device pixel ratio, so later launches read one
+// small PNG instead of walking the theme directories.
+class IconCache : public QObject {
+    Q_OBJECT
+public:
+    static IconCache* instance() {
+        static QPointer<IconCache> cache;
+        if (!cache) cache = new IconCache(qApp);
+        return cache;
+    }
+
+    static QString cacheDir() {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/icons";
+    }
+
+    // name is a theme icon name or a file/resource path.
+    void apply(QLabel* label, const QString& name, int size) {
+        const qreal dpr = label->devicePixelRatioF();
+        const QString key = cacheKey(name, size, dpr);
+        if (pixmaps.contains(key)) {
+            label->setPixmap(pixmaps.value(key));
+            return;
+        }
+
+        QPixmap placeholder(QSize(size, size) * dpr);
+        placeholder.setDevicePixelRatio(dpr);
+        placeholder.fill(Qt::transparent);
+        label->setPixmap(placeholder);
+
+        const bool started = pending.contains(key);
+        pending[key] << label;
+        if (!started) request(key, name, size, dpr);
+    }
+
+    // For views that paint icons themselves: the pixmap once it is
+    // resolved, until then a null pixmap and iconReady() when it is.
+    QPixmap pixmap(const QString& name, int size, qreal dpr) {
+        const QString key = cacheKey(name, size, dpr);
+        const auto it = pixmaps.constFind(key);
+        if (it != pixmaps.cend()) return *it;
+        if (!pending.contains(key)) {
+            pending.insert(key, {});
+            request(key, name, size, dpr);
+        }
+        return QPixmap();
+    }
+
+signals:
+    void iconReady(const QString& name);
+
+private:
+    using QObject::QObject;
+
+    void request(const QString& key, const QString& name, int size, qreal dpr) {
+        const QString diskPath = cacheDir() + "/" + key + ".png";
+        const QStringList searchPaths = QIcon::themeSearchPaths();
+        const QString theme = QIcon::themeName();
+        QPointer<IconCache> self = this;
+        QThreadPool::globalInstance()->start([self, key, name, size, dpr, diskPath, searchPaths, theme]() {
+            QImage image = load(name, size, dpr, diskPath, searchPaths, theme);
+            QMetaObject::invokeMethod(self.data(), [self, key, name, size, dpr, image]() {
+                if (self) self->deliver(key, name, size, dpr, image);
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    QString cacheKey(const QString& name, int size, qreal dpr) const {
+        const QString id = QString("%1\n%2\n%3\n%4").arg(QIcon::themeName(), name).arg(size).arg(dpr);
+        return QString::fromLatin1(QCryptographicHash::hash(id.toUtf8(), QCryptographicHash::Sha1).toHex());
+    }
+
+    // Runs on a worker thread: disk cache first, then the theme.
+    static QImage load(const QString& name, int size, qreal dpr, const QString& diskPath,
+                       const QStringList& searchPaths, const QString& theme) {
+        TRACE_SCOPE("IconCache::load");
+        QImage image(diskPath);
+        if (!image.isNull()) {
+            image.setDevicePixelRatio(dpr);
+            return image;
+        }
+
+        const QString file = name.startsWith(':') || name.startsWith('/')
+                                 ? name
+                                 : findThemeFile(name, qRound(size * dpr), searchPaths, theme);
+        if (file.isEmpty()) return image;
+        QImageReader reader(file);
+        const QSize pixels = QSize(size, size) * dpr;
+        if (reader.size().isValid() && reader.size() != pixels) {
+            reader.setScaledSize(reader.size().scaled(pixels, Qt::KeepAspectRatio));
+        }
+        image = reader.read();
+        if (image.isNull()) return image;
+        save(image, diskPath);
+        image.setDevicePixelRatio(dpr);
+        return image;
+    }
+
+    static void save(const QImage& image, const QString& path) {
+        QDir().mkpath(cacheDir());
+        QSaveFile out(path);
+        if (out.open(QIODevice::WriteOnly) && image.save(&out, "PNG")) out.commit();
+    }
+
+    // Follows the freedesktop icon theme layout: each theme's index.theme
+    // lists its directories and the themes it inherits, hicolor comes last.
+    // Only stat() calls, no directory walks.
+    static QString findThemeFile(const QString& name, int pixels, const QStringList& searchPaths,
+                                 const QString& theme) {
+        QStringList themes = {theme};
+        QSet<QString> visited;
+        for (int i = 0; i < themes.size() || !visited.contains("hicolor"); ++i) {
+            const QString current = i < themes.size() ? themes[i] : QString("hicolor");
+            if (current.isEmpty() || visited.contains(current)) continue;
+            visited.insert(current);
+
+            QString best;
+            int bestDistance = INT_MAX;
+            for (const QString& root : searchPaths) {
+                const QString base = root + "/" + current;
+                if (!QFile::exists(base + "/index.theme")) continue;
+                QSettings index(base + "/index.theme", QSettings::IniFormat);
+                for (const QString& inherited : index.value("Icon Theme/Inherits").toStringList()) {
+                    if (!themes.contains(inherited)) themes << inherited;
+                }
+                for (const QString& dir : index.value("Icon Theme/Directories").toStringList()) {
+                    const bool scalable = index.value(dir + "/Type").toString() == "Scalable";
+                    const int dirPixels = index.value(dir + "/Size").toInt() * index.value(dir + "/Scale", 1).toInt();
+                    for (const char* ext : {".svg", ".png"}) {
+                        const QString file = base + "/" + dir + "/" + name + ext;
+                        if (!QFile::exists(file)) continue;
+                        const int distance = scalable ? 0 : qAbs(dirPixels - pixels) + (dirPixels < pixels ? 1 : 0);
+                        if (distance < bestDistance) {
+                            bestDistance = distance;
+                            best = file;
+                        }
+                    }
+                    if (bestDistance == 0) return best;
+                }
+            }
+            if (!best.isEmpty()) return best;
+        }
+        for (const char* ext : {".svg", ".png", ".xpm"}) {
+            const QString file = QString("/usr/share/pixmaps/") + name + ext;
+            if (QFile::exists(file)) return file;
+        }
+        return QString();
+    }
+
+    void deliver(const QString& key, const QString& name, int size, qreal dpr, const QImage& image) {
+        QPixmap pixmap;
+        if (!image.isNull()) {
+            pixmap = QPixmap::fromImage(image);
+        } else {
+            // Not in a freedesktop theme on disk, e.g. served by the platform
+            // theme plugin. Ask QIcon once and cache what it renders.
+            TRACE_SCOPE("QIcon::fromTheme");
+            pixmap = QIcon::fromTheme(name).pixmap(QSize(size, size), dpr);
+            if (!pixmap.isNull()) {
+                const QImage rendered = pixmap.toImage();
+                const QString diskPath = cacheDir() + "/" + key + ".png";
+                QThreadPool::globalInstance()->start([rendered, diskPath]() { save(rendered, diskPath); });
+            }
+        }
+        pixmaps.insert(key, pixmap);
+        for (const QPointer<QLabel>& label : pending.take(key)) {
+            if (label && !pixmap.isNull()) label->setPixmap(pixmap);
+        }
+        emit iconReady(name);
+    }
+
+    QHash<QString, QPixmap> pixmaps;
+    QHash<QString, QList<QPointer<QLabel>>> pending;
+};
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <QObject>
+#include <QProcess>
+#include <QElapsedTimer>
+#include <QRegularExpression>
+#include <QStandardPaths>
+#include <QLocale>
+
+#include <unistd.h>
+
+#include "action.h"
+#include "offlinerepo.h"
+
+// Root shell session (pkexec, or plain bash when already root) that runs one
+// command at a time through a managed QProcess and turns apt's
+// APT::Status-Fd lines into progress, throughput and ETA.
+class InstallEngine : public QObject {
+    Q_OBJECT
+public:
+    explicit InstallEngine(QObject* parent = nullptr) : QObject(parent) {
+        proc.setProcessChannelMode(QProcess::MergedChannels);
+        connect(&proc, &QProcess::readyReadStandardOutput, this, &InstallEngine::readOutput);
+        connect(&proc, &QProcess::finished, this, &InstallEngine::processFinished);
+        connect(&proc, &QProcess::errorOccurred, this, [this](QProcess::ProcessError err) {
+            if (err == QProcess::FailedToStart) {
+                emit sessionEnded(false, "Could not start the installer: " + proc.errorString());
+            }
+        });
+    }
+
+    bool isRunning() const { return proc.state() != QProcess::NotRunning; }
+
+    // prefetched: a directory of .debs to seed apt's archive cache with.
+    // offlineRepo: a flat repository to install from instead of the
+    // configured mirrors, see OfflineRepo.
+    void startSession(const QString& prefetched = QString(), const QString& offlineRepo = QString()) {
+        if (isRunning()) return;
+
+        QString program;
+        QStringList args = {"env", "LC_ALL=C", "DEBIAN_FRONTEND=noninteractive", "bash", "-s"};
+        if (geteuid() == 0) {
+            program = args.takeFirst();
+        } else {
+            program = QStandardPaths::findExecutable("pkexec");
+            if (program.isEmpty()) {
+                emit sessionEnded(false, "pkexec is not installed, cannot install packages.");
+                return;
+            }
+        }
+
+        buffer.clear();
+        lastError.clear();
+        ending = false;
+        ready = false;
+        proc.start(program, args);
+
+        // Inside the root shell every apt call reports to stdout.
+        QString options = aptOptions();
+        // The marker shows the root shell runs; exit codes before it are pkexec's.
+        QString preamble = "echo " + readyMarker + "\n";
+        if (!offlineRepo.isEmpty()) {
+            // Only the local repository is visible to apt, with lists of its
+            // own so the system's lists are not replaced.
+            preamble += "once_src=$(mktemp -d)\n"
+                        "echo " + Action::quote(OfflineRepo::sourcesLine(offlineRepo)) + " > \"$once_src/once.list\"\n"
+                        "mkdir -p \"$once_src/parts\" /var/lib/once/lists/partial\n";
+            // SourceParts gets an empty dir; the list's own dir would add the entry twice.
+            options += " -o Dir::Etc::SourceList=\"$once_src/once.list\" -o Dir::Etc::SourceParts=\"$once_src/parts\""
+                       " -o Dir::State::Lists=/var/lib/once/lists/"
+                       " -o Dir::Cache::pkgcache= -o Dir::Cache::srcpkgcache=";
+        }
+        preamble +=
+            "apt() { command apt " + options + " \"$@\"; }\n"
+            "apt-get() { command apt-get " + options + " \"$@\"; }\n";
+        if (!prefetched.isEmpty()) {
+            preamble += "find " + Action::quote(prefetched) + " -maxdepth 1 -name '*.deb' "
+                        "-exec cp -t /var/cache/apt/archives/ {} + 2>/dev/null\n";
+        }
+        proc.write(preamble.toUtf8());
+    }
+
+    // Runs command in the session; actionFinished() reports its exit code.
+    void run(const QString& id, const QString& command) {
+        lastError.clear();
+        downloadBytes = 0;
+        lastPercent = -1;
+        rate = 0;
+        phase.clear();
+        clock.start();
+        proc.write(("{ " + command + "\n} </dev/null\necho " + marker + Action::quote(id) + ":$?\n").toUtf8());
+    }
+
+    void endSession() {
+        ending = true;
+        proc.write("exit 0\n");
+        proc.closeWriteChannel();
+    }
+
+    void abort() {
+        if (!isRunning()) return;
+        ending = true;
+        proc.kill();
+    }
+
+signals:
+    void progressChanged(int percent, const QString& text);
+    void logLine(const QString& line);
+    void actionFinished(const QString& id, int exitCode, const QString& error);
+    void sessionEnded(bool ok, const QString& error);
+
+private slots:
+    void readOutput() {
+        buffer += proc.readAllStandardOutput();
+        int nl;
+        while ((nl = buffer.indexOf('\n')) >= 0) {
+            QString line = QString::fromUtf8(buffer.left(nl)).trimmed();
+            buffer.remove(0, nl + 1);
+            if (!line.isEmpty()) parseLine(line);
+        }
+    }
+
+    void processFinished(int exitCode, QProcess::ExitStatus status) {
+        if (!buffer.isEmpty()) {
+            parseLine(QString::fromUtf8(buffer).trimmed());
+            buffer.clear();
+        }
+        if (status == QProcess::NormalExit && exitCode == 0 && ending) {
+            emit sessionEnded(true, QString());
+        } else if (status != QProcess::NormalExit) {
+            emit sessionEnded(false, "The installer was terminated unexpectedly.");
+        } else if (!ready && exitCode == 126) {
+            emit sessionEnded(false, "Authorization was cancelled.");
+        } else if (!ready && exitCode == 127) {
+            emit sessionEnded(false, "Authorization failed.");
+        } else {
+            emit sessionEnded(false, QString("The installer exited early (exit code %1).").arg(exitCode));
+        }
+    }
+
+private:
+    static QString aptOptions() {
+        return "-o APT::Status-Fd=1 -o Dpkg::Use-Pty=0 -o APT::Get::Assume-Yes=true "
+               "-o Dpkg::Options::=--force-confdef -o Dpkg::Options::=--force-confold";
+    }
+
+    void parseLine(const QString& line) {
+        if (line == readyMarker) {
+            ready = true;
+            return;
+        }
+        if (line.startsWith(marker)) {
+            const QString rest = line.mid(marker.size());
+            const qsizetype colon = rest.lastIndexOf(':');
+            const int code = rest.mid(colon + 1).toInt();
+            if (code == 0) emit progressChanged(100, "Done");
+            emit actionFinished(rest.left(colon), code, code == 0 ? QString() : lastError);
+            return;
+        }
+
+        // dlstatus:<n>:<percent>:<text> / pmstatus:<pkg>:<percent>:<text>
+        const QStringList f = line.split(':');
+        if (f.size() >= 4 && (f[0] == "dlstatus" || f[0] == "pmstatus" || f[0] == "pmerror")) {
+            if (f[0] == "pmerror") {
+                lastError = f.mid(3).join(':');
+                emit logLine(line);
+                return;
+            }
+            double pct = f[2].toDouble();
+            QString text = f.mid(3).join(':');
+            updateProgress(f[0], pct, text);
+            return;
+        }
+
+        static const QRegularExpression needRe(
+            "^Need to get ([\\d.,]+) ([kMG]?B)(?:/[\\d.,]+ [kMG]?B)? of archives");
+        auto m = needRe.match(line);
+        if (m.hasMatch()) {
+            downloadBytes = m.captured(1).remove(',').toDouble() * unitScale(m.captured(2));
+        }
+        if (line.startsWith("E: ")) lastError = line.mid(3);
+        emit logLine(line);
+    }
+
+    void updateProgress(const QString& kind, double pct, const QString& text) {
+        qint64 now = clock.elapsed();
+        if (kind != phase || pct < lastPercent) {
+            phase = kind;
+            lastPercent = pct;
+            lastTime = now;
+            rate = 0;
+        } else if (now > lastTime && pct > lastPercent) {
+            double r = (pct - lastPercent) / (now - lastTime);
+            rate = rate > 0 ? rate * 0.7 + r * 0.3 : r;
+            lastPercent = pct;
+            lastTime = now;
+        }
+
+        QString label = text;
+        if (kind == "dlstatus" && downloadBytes > 0 && rate > 0) {
+            label += " · " + QLocale().formattedDataSize(qint64(rate * 1000 * downloadBytes / 100)) + "/s";
+        }
+        if (rate > 0 && pct < 100) {
+            int secs = int((100 - pct) / rate / 1000);
+            label += QString(" · %1:%2 left").arg(secs / 60).arg(secs % 60, 2, 10, QChar('0'));
+        }
+        emit progressChanged(int(pct), label);
+    }
+
+    static double unitScale(const QString& unit) {
+        if (unit == "kB") return 1000.0;
+        if (unit == "MB") return 1000.0 * 1000;
+        if (unit == "GB") return 1000.0 * 1000 * 1000;
+        return 1.0;
+    }
+
+    inline static const QString marker = "@@once:done:";
+    inline static const QString readyMarker = "@@once:ready";
+
+    QProcess proc;
+    QByteArray buffer;
+    QElapsedTimer clock;
+    QString phase;
+    QString lastError;
+    bool ending = false;
+    bool ready = false;
+    double downloadBytes = 0;
+    double lastPercent = -1;
+    double rate = 0;
+    qint64 lastTime = 0;
+};
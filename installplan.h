@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QStringList>
+
+#include "action.h"
+#include "profilecatalog.h"
+
+// Turns a profile selection into the ordered action list that both the
+// wizard and headless mode run.
+class InstallPlan {
+public:
+    // apt update first, then the shared install transaction for the missing
+    // packages, then each selected profile's own actions with their ids
+    // scoped to the profile.
+    static QList<Action> build(const QMap<QString, Profile>& profiles, const QSet<QString>& selected,
+                               const QStringList& missing) {
+        QList<Action> plan;
+        plan << Action{"update", Action::Run, {"apt-get", "update"}, {}};
+        if (!missing.isEmpty()) {
+            plan << Action{"install", Action::AptInstall, missing, {"update"}};
+        }
+        for (auto it = profiles.cbegin(); it != profiles.cend(); ++it) {
+            if (!selected.contains(it.key())) continue;
+            for (const Action& a : it->actions) {
+                Action scoped = a;
+                scoped.id = it.key() + "/" + a.id;
+                scoped.after.clear();
+                for (const QString& dep : a.after) scoped.after << it.key() + "/" + dep;
+                if (a.needsLock()) scoped.after << "update";
+                plan << scoped;
+            }
+        }
+        return plan;
+    }
+
+    // Packages of the sorted install set that are not installed yet.
+    static QStringList missing(const QStringList& packages, const QSet<QString>& installed) {
+        QStringList result;
+        for (const QString& pkg : packages) {
+            if (!installed.contains(pkg)) result << pkg;
+        }
+        return result;
+    }
+
+    // A plan that only refreshes the package lists has nothing to install.
+    static bool isEmpty(const QList<Action>& plan) { return plan.size() <= 1; }
+
+    static QString preview(const QList<Action>& plan) {
+        QStringList steps;
+        for (const Action& a : plan) steps << a.preview();
+        return steps.join(" && ");
+    }
+};
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QSet>
+#include <QStandardPaths>
+#include <QString>
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "action.h"
+
+// Append-only record of an install in progress, so an interrupted install
+// continues where it stopped instead of starting over. One record per
+// line, prefixed with a CRC of the rest:
+//   <crc> profile <id>    the selection the plan was built from
+//   <crc> plan <action>   an action of that plan
+//   <crc> done <action>   an action that finished successfully
+// Each append is a single write() followed by fsync(), so after a crash the
+// file holds every record that was acknowledged plus at most one torn line,
+// which fails its checksum and is cut off before the next append. The file
+// is removed once the whole plan is done.
+class InstallJournal {
+public:
+    InstallJournal() = default;
+    InstallJournal(const InstallJournal&) = delete;
+    InstallJournal& operator=(const InstallJournal&) = delete;
+    ~InstallJournal() { close(); }
+
+    static QString path() {
+        return QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/once/install.journal";
+    }
+
+    // Reads what a previous run left behind.
+    void load() {
+        close();
+        reset();
+        QFile f(path());
+        if (!f.open(QIODevice::ReadOnly)) return;
+        const QByteArray data = f.readAll();
+        qsizetype pos = 0;
+        while (pos < data.size()) {
+            const qsizetype eol = data.indexOf('\n', pos);
+            if (eol < 0 || !parse(QByteArrayView(data).sliced(pos, eol - pos))) break;
+            pos = eol + 1;
+        }
+        validBytes = pos;
+    }
+
+    bool pending() const { return !profileIds.isEmpty(); }
+    QSet<QString> profiles() const { return profileIds; }
+    bool isDone(const QString& action) const { return done.contains(action); }
+    int doneCount() const { return int(done.size()); }
+
+    // Journals an install of selection. The selection of the pending run
+    // continues it with its finished actions kept, any other starts over.
+    bool begin(const QSet<QString>& selection, const QList<Action>& plan) {
+        if (selection != profileIds) {
+            close();
+            QFile::remove(path());
+            reset();
+        }
+        QByteArray records;
+        for (const QString& id : selection) {
+            if (!profileIds.contains(id)) records += record("profile", id);
+        }
+        for (const Action& a : plan) {
+            if (!planned.contains(a.id)) records += record("plan", a.id);
+        }
+        profileIds = selection;
+        for (const Action& a : plan) planned.insert(a.id);
+        return records.isEmpty() ? open() : append(records);
+    }
+
+    void markDone(const QString& action) {
+        if (done.contains(action)) return;
+        done.insert(action);
+        append(record("done", action));
+    }
+
+    // The plan is through; nothing is left to resume.
+    void finish() {
+        close();
+        QFile::remove(path());
+        reset();
+    }
+
+private:
+    void reset() {
+        profileIds.clear();
+        planned.clear();
+        done.clear();
+        validBytes = 0;
+    }
+
+    static QByteArray record(const char* kind, const QString& arg) {
+        const QByteArray body = QByteArray(kind) + ' ' + arg.toUtf8();
+        return QByteArray::number(qChecksum(body), 16).rightJustified(4, '0') + ' ' + body + '\n';
+    }
+
+    bool parse(QByteArrayView line) {
+        const qsizetype crcEnd = line.indexOf(' ');
+        if (crcEnd != 4) return false;
+        const QByteArrayView body = line.sliced(5);
+        bool ok = false;
+        const quint16 crc = line.first(4).toByteArray().toUShort(&ok, 16);
+        if (!ok || crc != qChecksum(body)) return false;
+        const qsizetype kindEnd = body.indexOf(' ');
+        if (kindEnd < 0) return false;
+        const QByteArray kind = body.first(kindEnd).toByteArray();
+        const QString arg = QString::fromUtf8(body.sliced(kindEnd + 1));
+        if (kind == "profile") profileIds.insert(arg);
+        else if (kind == "plan") planned.insert(arg);
+        else if (kind == "done") done.insert(arg);
+        else return false;
+        return true;
+    }
+
+    bool open() {
+        if (fd >= 0) return true;
+        const QString dir = QFileInfo(path()).absolutePath();
+        if (!QDir().mkpath(dir)) return false;
+        fd = ::open(QFile::encodeName(path()).constData(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+        if (fd < 0) return false;
+        // Drop a torn last record so the next one starts on its own line.
+        if (::ftruncate(fd, validBytes) != 0) {
+            close();
+            return false;
+        }
+        // Make the file's directory entry durable too.
+        const int dirFd = ::open(QFile::encodeName(dir).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dirFd >= 0) {
+            ::fsync(dirFd);
+            ::close(dirFd);
+        }
+        return true;
+    }
+
+    bool append(const QByteArray& records) {
+        if (!open()) return false;
+        const char* p = records.constData();
+        qsizetype left = records.size();
+        while (left > 0) {
+            const ssize_t n = ::write(fd, p, size_t(left));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            p += n;
+            left -= n;
+        }
+        if (::fsync(fd) != 0) return false;
+        validBytes += records.size();
+        return true;
+    }
+
+    void close() {
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+    }
+
+    QSet<QString> profileIds;
+    QSet<QString> planned;
+    QSet<QString> done;
+    qint64 validBytes = 0;
+    int fd = -1;
+};
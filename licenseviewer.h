@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QMainWindow>
+#include <QWidget>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QClipboard>
+#include <QGuiApplication>
+#include <QCloseEvent>
+#include <QFile>
+
+#include "devicetier.h"
+#include "revealview.h"
+
+class LicenseViewer : public QMainWindow {
+    Q_OBJECT
+    friend class OnboardingTourBench;
+public:
+    explicit LicenseViewer(QWidget* parent = nullptr)
+        : QMainWindow(parent) {
+        setWindowTitle("License Agreement");
+        resize(760, 520);
+        setWindowModality(Qt::ApplicationModal);
+        setWindowFlags(windowFlags() & ~Qt::WindowMinimizeButtonHint & ~Qt::WindowCloseButtonHint);
+        auto* central = new QWidget(this);
+        auto* layout = new QVBoxLayout(central);
+
+        textView = new RevealView(this);
+        textView->setObjectName("licenseView");
+        textView->setAnimated(DeviceTier::current().animated());
+        // Starts slow and speeds up, like someone reading less and less carefully.
+        textView->setRate([](double progress) {
+            if (progress < 0.1) return 2.0 / 50;
+            if (progress < 0.3) return 5.0 / 30;
+            if (progress < 0.6) return 15.0 / 10;
+            return 30.0;
+        });
+
+        auto* btnLayout = new QHBoxLayout();
+
+        auto* copyBtn = new QPushButton("Copy to Clipboard", this);
+        copyBtn->setObjectName("copyButton");
+        connect(copyBtn, &QPushButton::clicked, this, [this]() {
+            QGuiApplication::clipboard()->setText(textView->text());
+        });
+
+        okBtn = new QPushButton("OK", this);
+        okBtn->setObjectName("okButton");
+        okBtn->setVisible(false);
+        connect(okBtn, &QPushButton::clicked, this, &LicenseViewer::close);
+
+        btnLayout->addWidget(copyBtn);
+        btnLayout->addStretch();
+        btnLayout->addWidget(okBtn);
+
+        layout->addWidget(new QLabel("<h3 style='color: #e0e0ff; text-align: center;'>Terms of error</h3>"));
+        layout->addWidget(textView, 1);
+        layout->addLayout(btnLayout);
+
+        setCentralWidget(central);
+
+        connect(textView, &RevealView::revealFinished, okBtn, &QPushButton::show);
+        textView->setText(licenseText());
+        textView->startReveal();
+    }
+
+    // The text shown on the license page, error.os notes followed by the
+    // Apache License. Stored compressed in the resources, decompressed on
+    // first use and shared by every viewer from then on.
+    static const QString& licenseText() {
+        static const QString text = []() {
+            QFile file(":/license.txt");
+            return file.open(QIODevice::ReadOnly) ? QString::fromUtf8(file.readAll()) : QString();
+        }();
+        return text;
+    }
+
+signals:
+    void finished();
+
+protected:
+    void closeEvent(QCloseEvent* event) override {
+        emit finished();
+        event->accept();
+    }
+
+private:
+    RevealView* textView = nullptr;
+    QPushButton* okBtn = nullptr;
+};
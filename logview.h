@@ -0,0 +1,172 @@
+#pragma once
+
+#include <QAbstractScrollArea>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScrollBar>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <vector>
+
+#include "trace.h"
+
+// The most recent output lines in a fixed memory budget. Line bytes are
+// stored back to back in a circular byte buffer and a circular index of
+// (offset, length) pairs finds line n in constant time. Appending evicts
+// the oldest lines once either buffer is full, so memory stays the same
+// no matter how long the install runs.
+class LogBuffer {
+public:
+    explicit LogBuffer(qsizetype bytes = 1 << 20, qsizetype maxLines = 1 << 15)
+        : data(bytes, '\0'), entries(maxLines) {}
+
+    qsizetype size() const { return count; }
+    quint64 appended() const { return total; }
+
+    // 0 is the oldest line still kept.
+    QString line(qsizetype i) const {
+        const Entry& e = entries[(first + i) % entries.size()];
+        return QString::fromUtf8(data.constData() + e.offset, e.length);
+    }
+
+    void append(QByteArrayView line) {
+        ++total;
+        const qsizetype cap = data.size();
+        const qsizetype len = std::min(line.size(), cap);
+        qsizetype pos = writePos;
+        if (pos + len > cap) {
+            // Wrap. The lines in the tail we skip are now the oldest.
+            while (count > 0 && oldest().offset >= pos) dropOldest();
+            pos = 0;
+        }
+        while (count > 0 && (count == qsizetype(entries.size()) || overlaps(oldest(), pos, len))) dropOldest();
+
+        std::copy_n(line.data(), len, data.data() + pos);
+        entries[(first + count) % entries.size()] = {pos, len};
+        ++count;
+        writePos = pos + len;
+    }
+
+    void clear() {
+        first = count = writePos = 0;
+        total = 0;
+    }
+
+private:
+    struct Entry {
+        qsizetype offset = 0;
+        qsizetype length = 0;
+    };
+
+    const Entry& oldest() const { return entries[first]; }
+
+    void dropOldest() {
+        first = (first + 1) % entries.size();
+        --count;
+        if (count == 0) first = writePos = 0;
+    }
+
+    static bool overlaps(const Entry& e, qsizetype pos, qsizetype len) {
+        return e.offset < pos + len && pos < e.offset + e.length;
+    }
+
+    QByteArray data;
+    std::vector<Entry> entries;
+    qsizetype first = 0;
+    qsizetype count = 0;
+    qsizetype writePos = 0;
+    quint64 total = 0;
+};
+
+// Virtualized view over a LogBuffer: only the rows in the viewport are
+// painted, so scrolling costs the same with 50 lines or 50k. Follows new
+// output while scrolled to the bottom. Every line is also written to a
+// log file for post-mortems, see logPath(); it holds the current run and
+// the previous one is kept beside it with a .1 suffix.
+class LogView : public QAbstractScrollArea {
+    Q_OBJECT
+public:
+    explicit LogView(QWidget* parent = nullptr) : QAbstractScrollArea(parent) {
+        setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+        setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+    }
+
+    static QString logPath() {
+        return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/install.log";
+    }
+
+    // Starts a new run: empties the view and starts a fresh log file, so
+    // retries never grow it past two runs.
+    void begin() {
+        buffer.clear();
+        file.close();
+        const QString path = logPath();
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QFile::remove(path + ".1");
+        QFile::rename(path, path + ".1");
+        file.setFileName(path);
+        if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            file.write("=== " + QDateTime::currentDateTime().toString(Qt::ISODate).toUtf8() + " ===\n");
+            file.flush();
+        }
+        refresh();
+    }
+
+    void appendLine(const QString& line) {
+        const QByteArray utf8 = line.toUtf8();
+        buffer.append(utf8);
+        if (file.isOpen()) {
+            file.write(utf8);
+            file.write("\n", 1);
+            file.flush();
+        }
+        refresh();
+    }
+
+    const LogBuffer& lines() const { return buffer; }
+
+protected:
+    void paintEvent(QPaintEvent* e) override {
+        TRACE_SCOPE("LogView::paint");
+        QPainter p(viewport());
+        p.setPen(palette().color(QPalette::Text));
+        const int h = rowHeight();
+        const qsizetype top = verticalScrollBar()->value();
+        const qsizetype from = top + e->rect().top() / h;
+        const qsizetype to = std::min(buffer.size(), top + e->rect().bottom() / h + 1);
+        const QFontMetrics fm = fontMetrics();
+        for (qsizetype i = from; i < to; ++i) {
+            const int y = int(i - top) * h;
+            const QString text = fm.elidedText(buffer.line(i), Qt::ElideRight, viewport()->width() - 2 * margin);
+            p.drawText(margin, y + fm.ascent(), text);
+        }
+    }
+
+    void resizeEvent(QResizeEvent* e) override {
+        QAbstractScrollArea::resizeEvent(e);
+        refresh();
+    }
+
+private:
+    int rowHeight() const { return std::max(1, fontMetrics().height()); }
+
+    void refresh() {
+        QScrollBar* bar = verticalScrollBar();
+        const bool follow = bar->value() >= bar->maximum();
+        const int visible = viewport()->height() / rowHeight();
+        bar->setPageStep(visible);
+        bar->setSingleStep(1);
+        bar->setRange(0, int(std::max<qsizetype>(0, buffer.size() - visible)));
+        if (follow) bar->setValue(bar->maximum());
+        viewport()->update();
+    }
+
+    static constexpr int margin = 4;
+    LogBuffer buffer;
+    QFile file;
+};
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QProcess>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include <functional>
+
+#include "action.h"
+
+// A flat apt repository holding the full .deb closure of some profiles,
+// for provisioning devices without (fast) network. Built with
+//   once --build-repo /media/usb/once-repo --profiles essential,dev
+// Its index is not signed, so a repository is only used when asked for:
+// with --repo=<dir> or $ONCE_REPO, or when the user confirms one that
+// discovered() found in once/repo in the XDG data dirs or as a once-repo
+// directory at the top of mounted media. Files of fetch-url actions are
+// stored under files/ so those need no network either.
+class OfflineRepo {
+public:
+    using Log = std::function<void(const QString&)>;
+
+    static bool isRepo(const QString& dir) { return !dir.isEmpty() && QFile::exists(dir + "/Packages"); }
+
+    // Why apt could not use dir as a repository, or an empty string. A
+    // sources.list entry is split at whitespace and brackets open options.
+    static QString problem(const QString& dir) {
+        const QString path = pathProblem(dir);
+        if (!path.isEmpty()) return path;
+        if (!isRepo(dir)) return "Not an offline repository (no Packages index): " + dir;
+        return QString();
+    }
+
+    // The repository given with --repo=<dir> or $ONCE_REPO, if any.
+    static QString requested() {
+        QString dir = qEnvironmentVariable("ONCE_REPO");
+        const QStringList args = QCoreApplication::arguments();
+        for (qsizetype i = 1; i < args.size(); ++i) {
+            if (args[i].startsWith("--repo=")) dir = args[i].mid(7);
+            else if (args[i] == "--repo" && i + 1 < args.size()) dir = args[++i];
+        }
+        return dir.isEmpty() ? QString() : QFileInfo(dir).absoluteFilePath();
+    }
+
+    // Usable repositories lying around. Anyone who can plug in a USB stick
+    // can put one there, so these are offers to confirm, never used as is.
+    static QStringList discovered() {
+        QStringList candidates = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, "once/repo",
+                                                           QStandardPaths::LocateDirectory);
+        // /media/<label>, /media/<user>/<label> and /run/media/<user>/<label>
+        for (const QString& base : {QString("/media"), QString("/run/media")}) {
+            for (const QFileInfo& a : QDir(base).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+                candidates << a.filePath() + "/once-repo";
+                for (const QFileInfo& b : QDir(a.filePath()).entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+                    candidates << b.filePath() + "/once-repo";
+                }
+            }
+        }
+        QStringList found;
+        for (const QString& dir : std::as_const(candidates)) {
+            if (problem(dir).isEmpty()) found << QFileInfo(dir).absoluteFilePath();
+        }
+        return found;
+    }
+
+    // The one-line sources.list entry for a repo.
+    static QString sourcesLine(const QString& dir) { return "deb [trusted=yes] file:" + dir + " ./"; }
+
+    static QString fileFor(const QString& dir, const QString& name) { return dir + "/files/" + name; }
+
+    // Blocking, meant for the command line. Downloads the files of the
+    // fetch-url actions, then the closure of packages plus the dependencies
+    // of those downloads, resolved against an empty dpkg status so nothing
+    // on this machine is assumed to be installed on the target. Finally
+    // writes the Packages index.
+    static bool build(const QString& dir, QStringList packages, const QList<Action>& fetches, const Log& log,
+                      QString& error) {
+        error = pathProblem(dir);
+        if (!error.isEmpty()) return false;
+        if (!QDir().mkpath(dir + "/files") || !QDir().mkpath(dir + "/partial")) {
+            error = "Cannot create " + dir;
+            return false;
+        }
+
+        QNetworkAccessManager nam;
+        for (const Action& a : fetches) {
+            const QString target = fileFor(dir, a.args.value(1));
+            log("Downloading " + a.args.value(0));
+            if (!fetch(nam, QUrl(a.args.value(0)), target, error)) return false;
+            if (target.endsWith(".deb")) packages << debDepends(target);
+        }
+        packages.removeDuplicates();
+
+        QTemporaryDir work;
+        QFile status(work.filePath("status"));
+        if (!work.isValid() || !status.open(QIODevice::WriteOnly)) {
+            error = "Cannot create a temporary directory";
+            return false;
+        }
+        status.close();
+
+        if (!packages.isEmpty()) {
+            QProcess apt;
+            apt.setProcessChannelMode(QProcess::MergedChannels);
+            QObject::connect(&apt, &QProcess::readyReadStandardOutput, [&apt, &log]() {
+                while (apt.canReadLine()) log(QString::fromUtf8(apt.readLine()).trimmed());
+            });
+            apt.start("apt-get", QStringList{"-q", "-y",
+                                             "-o", "Debug::NoLocking=1",
+                                             "-o", "Dir::Cache::Archives=" + dir + "/",
+                                             "-o", "Dir::State::status=" + status.fileName(),
+                                             "-o", "Dir::Cache::pkgcache=",
+                                             "-o", "Dir::Cache::srcpkgcache=",
+                                             "--download-only", "install"} + packages);
+            apt.waitForFinished(-1);
+            if (apt.exitStatus() != QProcess::NormalExit || apt.exitCode() != 0) {
+                error = "apt-get could not download the package closure";
+                return false;
+            }
+        }
+        QDir(dir + "/partial").removeRecursively();
+        QFile::remove(dir + "/lock");
+
+        log("Writing the Packages index");
+        return writeIndex(dir, error);
+    }
+
+private:
+    static QString pathProblem(const QString& dir) {
+        static const QRegularExpression unsafe("[\\s\\[\\]#]");
+        if (!dir.contains(unsafe)) return QString();
+        return "The offline repository path must not contain spaces, '[', ']' or '#': " + dir;
+    }
+
+    static bool fetch(QNetworkAccessManager& nam, const QUrl& url, const QString& target, QString& error) {
+        QSaveFile out(target);
+        if (!out.open(QIODevice::WriteOnly)) {
+            error = "Cannot write " + target;
+            return false;
+        }
+        QNetworkReply* reply = nam.get(QNetworkRequest(url));
+        QObject::connect(reply, &QNetworkReply::readyRead, [reply, &out]() { out.write(reply->readAll()); });
+        QEventLoop loop;
+        QObject::connect(reply, &QNetworkReply::finished, &loop, &QEventLoop::quit);
+        loop.exec();
+        out.write(reply->readAll());
+        const bool ok = reply->error() == QNetworkReply::NoError && out.commit();
+        if (!ok) error = url.toString() + ": " + reply->errorString();
+        reply->deleteLater();
+        return ok;
+    }
+
+    // Package names of a .deb's Depends and Pre-Depends, first alternative
+    // of each, without version constraints or architecture qualifiers.
+    static QStringList debDepends(const QString& deb) {
+        QStringList names;
+        for (const char* field : {"Depends", "Pre-Depends"}) {
+            const QByteArray value = control(deb, {field}).trimmed();
+            if (value.isEmpty()) continue;
+            for (const QByteArray& dep : value.split(',')) {
+                QByteArray name = dep.split('|').first().trimmed();
+                name = name.left(name.indexOf(' ') < 0 ? name.size() : name.indexOf(' '));
+                name = name.left(name.indexOf(':') < 0 ? name.size() : name.indexOf(':'));
+                if (!name.isEmpty()) names << QString::fromUtf8(name);
+            }
+        }
+        return names;
+    }
+
+    static QByteArray control(const QString& deb, const QStringList& fields = {}) {
+        QProcess p;
+        p.start("dpkg-deb", QStringList{"-f", deb} + fields);
+        p.waitForFinished(-1);
+        return p.exitCode() == 0 ? p.readAllStandardOutput() : QByteArray();
+    }
+
+    // The same stanzas dpkg-scanpackages would write: the control fields
+    // plus Filename, Size and SHA256.
+    static bool writeIndex(const QString& dir, QString& error) {
+        QByteArray index;
+        const QFileInfoList debs = QDir(dir).entryInfoList({"*.deb"}, QDir::Files, QDir::Name);
+        for (const QFileInfo& fi : debs) {
+            QByteArray stanza = control(fi.filePath());
+            if (stanza.isEmpty()) continue;
+            QFile deb(fi.filePath());
+            QCryptographicHash sha(QCryptographicHash::Sha256);
+            if (!deb.open(QIODevice::ReadOnly) || !sha.addData(&deb)) continue;
+            if (!stanza.endsWith('\n')) stanza += '\n';
+            stanza += "Filename: ./" + fi.fileName().toUtf8() + "\n";
+            stanza += "Size: " + QByteArray::number(fi.size()) + "\n";
+            stanza += "SHA256: " + sha.result().toHex() + "\n\n";
+            index += stanza;
+        }
+        QSaveFile out(dir + "/Packages");
+        if (!out.open(QIODevice::WriteOnly) || out.write(index) != index.size() || !out.commit()) {
+            error = "Cannot write " + dir + "/Packages";
+            return false;
+        }
+        return true;
+    }
+};
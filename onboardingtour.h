@@ -0,0 +1,758 @@
+#pragma once
+
+#include <QApplication>
+#include <QWidget>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QProgressBar>
+#include <QLineEdit>
+#include <QStackedWidget>
+#include <QProcess>
+#include <QMessageBox>
+#include <QTimer>
+#include <QKeyEvent>
+#include <QIcon>
+#include <QPainter>
+#include <QPainterPath>
+#include <QScreen>
+#include <QGuiApplication>
+#include <QSet>
+#include <QMap>
+#include <QMenuBar>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
+#include <QScrollBar>
+#include <QWindow>
+#include <QLocale>
+#include <QElapsedTimer>
+
+#include "actionscheduler.h"
+#include "aptindex.h"
+#include "catalogview.h"
+#include "devicetier.h"
+#include "dpkgstatus.h"
+#include "iconcache.h"
+#include "installplan.h"
+#include "journal.h"
+#include "licenseviewer.h"
+#include "logview.h"
+#include "offlinerepo.h"
+#include "packageindex.h"
+#include "perfoverlay.h"
+#include "prefetcher.h"
+#include "profilecatalog.h"
+#include "resolver.h"
+#include "revealview.h"
+#include "theme.h"
+#include "trace.h"
+
+class OnboardingTour : public QWidget {
+    Q_OBJECT
+    friend class OnboardingTourBench;
+
+    QStackedWidget* stack;
+    QPushButton *nextBtn, *backBtn, *closeBtn;
+    QProgressBar* progress;
+    QMap<QString, Profile> profiles;
+    QSet<QString> selected;
+    PackageIndex packageIndex;
+    AptIndex aptIndex;
+    DependencyResolver resolver;
+    CatalogModel* catalog = nullptr;
+    QLineEdit* catalogSearch = nullptr;
+    CatalogView* catalogView = nullptr;
+    QSet<QString> installedPackages;
+    QLabel* sizeLabel = nullptr;
+    QSet<int> builtSteps;
+    RevealView* cmdView = nullptr;
+    QPixmap background;
+    bool screenTracked = false;
+    bool painted = false;
+    int step = 0;
+    bool winKeyPressed = false;
+    bool licenseOK = false;
+
+    QString targetCmd;
+    bool commandPending = false;
+
+    ActionScheduler* installer;
+    Prefetcher* prefetcher;
+    QProgressBar* installBar = nullptr;
+    QLabel* installStatus = nullptr;
+    LogView* installLog = nullptr;
+    QString offlineRepo;
+    bool repoOffered = false;
+    InstallJournal journal;
+    PerfOverlay* perfOverlay = nullptr;
+
+public:
+    OnboardingTour(QWidget* parent = nullptr) : QWidget(parent) {
+        TRACE_SCOPE("OnboardingTour");
+        setWindowFlags(Qt::FramelessWindowHint);
+        if (DeviceTier::current().translucent()) setAttribute(Qt::WA_TranslucentBackground);
+        QScreen* screen = QGuiApplication::primaryScreen();
+        setGeometry(screen->geometry());
+
+        installer = new ActionScheduler(this);
+        connect(installer, &ActionScheduler::progressChanged, this, [this](int percent, const QString& text) {
+            installBar->setValue(percent);
+            installStatus->setText(text);
+        });
+        connect(installer, &ActionScheduler::logLine, this, [this](const QString& line) {
+            if (installLog) installLog->appendLine(line);
+        });
+        connect(installer, &ActionScheduler::finished, this, &OnboardingTour::installFinished);
+
+        setupProfiles();
+        setupUI();
+        installEventFilter(this);
+        connect(IconCache::instance(), &IconCache::iconReady, this, [this](const QString& name) {
+            if (name == "start-here" || name == "window-close") applyFrameIcons();
+        });
+        applyFrameIcons();
+
+        // With an offline repository there is nothing to prefetch.
+        offlineRepo = OfflineRepo::requested();
+        if (!offlineRepo.isEmpty() && !OfflineRepo::problem(offlineRepo).isEmpty()) {
+            qWarning("once: %s", qPrintable(OfflineRepo::problem(offlineRepo)));
+            offlineRepo.clear();
+        }
+        prefetcher = new Prefetcher(this);
+        if (!offlineRepo.isEmpty()) prefetcher->stop();
+        prefetcher->setPackages(selectedApps());
+        showStep(0);
+
+        journal.load();
+        if (journal.pending()) QTimer::singleShot(0, this, &OnboardingTour::resumeInstall);
+    }
+
+    void paintEvent(QPaintEvent* e) override {
+        TRACE_SCOPE("OnboardingTour::paint");
+        if (!painted) {
+            painted = true;
+            Trace::instant("first paint");
+        }
+        if (background.isNull()) rebuildBackground();
+        QPainter p(this);
+        p.setCompositionMode(QPainter::CompositionMode_Source);
+        const qreal dpr = background.devicePixelRatio();
+        for (const QRect& r : e->region()) {
+            p.drawPixmap(r, background, QRectF(QPointF(r.topLeft()) * dpr, QSizeF(r.size()) * dpr));
+        }
+    }
+
+    void resizeEvent(QResizeEvent* e) override {
+        QWidget::resizeEvent(e);
+        rebuildBackground();
+    }
+
+    void showEvent(QShowEvent* e) override {
+        QWidget::showEvent(e);
+        if (windowHandle() && !screenTracked) {
+            screenTracked = true;
+            connect(windowHandle(), &QWindow::screenChanged, this, [this](QScreen* screen) {
+                if (!screen) return;
+                if (geometry() == screen->geometry()) rebuildBackground();
+                else setGeometry(screen->geometry());
+            });
+        }
+    }
+
+    bool eventFilter(QObject*, QEvent* e) override {
+        if (e->type() == QEvent::KeyPress && static_cast<QKeyEvent*>(e)->key() == Qt::Key_F12) {
+            if (!perfOverlay) perfOverlay = new PerfOverlay(this);
+            if (static_cast<QKeyEvent*>(e)->modifiers() & Qt::ShiftModifier) perfOverlay->exportSamples();
+            else perfOverlay->toggle();
+            return true;
+        }
+        if (step == 1 && e->type() == QEvent::KeyPress) {
+            QKeyEvent* ke = static_cast<QKeyEvent*>(e);
+            if (ke->key() == Qt::Key_Meta || ke->key() == Qt::Key_Super_L) {
+                winKeyPressed = true;
+                nextBtn->setEnabled(true);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // A top-level widget paints and flushes all of its children on an
+    // update request; timed here for the perf overlay.
+    bool event(QEvent* e) override {
+        if (e->type() != QEvent::UpdateRequest || !perfOverlay) return QWidget::event(e);
+        QElapsedTimer timer;
+        timer.start();
+        const bool handled = QWidget::event(e);
+        perfOverlay->framePainted(timer.nsecsElapsed());
+        return handled;
+    }
+
+private:
+    // The rounded frame and its mask only change with the size or screen, so
+    // they are rendered once into a pixmap that paintEvent() blits from.
+    // Opaque tiers get a plain rectangle and no mask.
+    void rebuildBackground() {
+        TRACE_SCOPE("rebuildBackground");
+        const qreal dpr = devicePixelRatioF();
+        background = QPixmap(size() * dpr);
+        background.setDevicePixelRatio(dpr);
+        if (!DeviceTier::current().translucent()) {
+            background.fill(QColor(10, 10, 10));
+            clearMask();
+            update();
+            return;
+        }
+
+        const int margin = 20;
+        QPainterPath path;
+        path.addRoundedRect(rect().adjusted(margin, margin, -margin, -margin), 20, 20);
+
+        background.fill(Qt::transparent);
+        QPainter p(&background);
+        p.setRenderHint(QPainter::Antialiasing);
+        p.fillPath(path, QColor(0, 0, 0, 245));
+        p.end();
+
+        setMask(QRegion(path.toFillPolygon().toPolygon()));
+        update();
+    }
+
+    // The window and close button icons come from IconCache like the page
+    // icons; each is set once its worker has resolved it.
+    void applyFrameIcons() {
+        const qreal dpr = devicePixelRatioF();
+        const QPixmap windowIcon = IconCache::instance()->pixmap("start-here", 64, dpr);
+        if (!windowIcon.isNull()) setWindowIcon(windowIcon);
+        const QPixmap closeIcon = IconCache::instance()->pixmap("window-close", closeBtn->iconSize().width(), dpr);
+        if (!closeIcon.isNull()) closeBtn->setIcon(closeIcon);
+    }
+
+    void setupProfiles() {
+        TRACE_SCOPE("setupProfiles");
+        profiles = ProfileCatalog::load();
+        installedPackages = DpkgStatus::installed();
+        for (auto it = profiles.cbegin(); it != profiles.cend(); ++it) {
+            if (it->preselected) {
+                selected.insert(it.key());
+                packageIndex.addProfile(it.key(), it->apps);
+            }
+        }
+    }
+
+    void setupUI() {
+        TRACE_SCOPE("setupUI");
+        QVBoxLayout* main = new QVBoxLayout(this);
+        main->setContentsMargins(40, 40, 40, 40);
+
+        QHBoxLayout* header = new QHBoxLayout();
+        QLabel* title = new QLabel("error.os Setup");
+        title->setObjectName("title");
+        closeBtn = new QPushButton();
+        closeBtn->setFixedSize(40, 40);
+        closeBtn->setObjectName("closeButton");
+        connect(closeBtn, &QPushButton::clicked, this, &OnboardingTour::handleClose);
+        header->addWidget(title);
+        header->addStretch();
+        header->addWidget(closeBtn);
+
+        progress = new QProgressBar();
+        progress->setRange(0, 100);
+        progress->setTextVisible(false);
+        progress->setFixedHeight(4);
+        progress->setObjectName("stepProgress");
+
+        stack = new QStackedWidget();
+        createSteps();
+
+        QHBoxLayout* footer = new QHBoxLayout();
+        backBtn = new QPushButton("Back");
+        nextBtn = new QPushButton("Next");
+        backBtn->setMinimumSize(120, 45);
+        nextBtn->setMinimumSize(140, 45);
+        backBtn->setObjectName("backButton");
+        nextBtn->setObjectName("nextButton");
+        connect(backBtn, &QPushButton::clicked, this, &OnboardingTour::handleBack);
+        connect(nextBtn, &QPushButton::clicked, this, &OnboardingTour::handleNext);
+        footer->addWidget(backBtn);
+        footer->addStretch();
+        footer->addWidget(nextBtn);
+
+        main->addLayout(header);
+        main->addWidget(progress);
+        main->addWidget(stack, 1);
+        main->addLayout(footer);
+    }
+
+    void createSteps() {
+        TRACE_SCOPE("createSteps");
+        for (int i = 0; i < 5; ++i) stack->addWidget(new QWidget());
+    }
+
+    // Pages are built the first time they are needed, see ensureStep().
+    void ensureStep(int s) {
+        if (s < 0 || s >= 5 || builtSteps.contains(s)) return;
+        builtSteps.insert(s);
+
+        QWidget* page = nullptr;
+        switch (s) {
+        case 0: page = createWelcomeStep(); break;
+        case 1: page = createWinKeyStep(); break;
+        case 2: page = createLicenseStep(); break;
+        case 3: page = createPackageStep(); break;
+        case 4: page = createDoneStep(); break;
+        }
+        QWidget* placeholder = stack->widget(s);
+        stack->insertWidget(s, page);
+        stack->removeWidget(placeholder);
+        delete placeholder;
+    }
+
+    QWidget* createWelcomeStep() {
+        TRACE_SCOPE("createWelcomeStep");
+        QWidget* s0 = new QWidget();
+        QVBoxLayout* l0 = new QVBoxLayout(s0);
+        l0->setAlignment(Qt::AlignCenter);
+        l0->setSpacing(30);
+        QLabel* icon0 = new QLabel();
+        IconCache::instance()->apply(icon0, "error.os", 148);
+        icon0->setAlignment(Qt::AlignCenter);
+        QLabel* t0 = new QLabel("Welcome to error.os");
+        t0->setObjectName("welcomeTitle");
+        QLabel* e0 = new QLabel("Neospace  2026");
+        e0->setObjectName("welcomeEdition");
+        e0->setAlignment(Qt::AlignCenter);
+        QLabel* d0 = new QLabel("Let's set up your system in a few simple steps");
+        d0->setObjectName("welcomeText");
+        d0->setAlignment(Qt::AlignCenter);
+        l0->addWidget(icon0);
+        l0->addWidget(t0);
+        l0->addWidget(e0);
+        l0->addWidget(d0);
+        return s0;
+    }
+
+    QWidget* createWinKeyStep() {
+        TRACE_SCOPE("createWinKeyStep");
+        QWidget* s1 = new QWidget();
+        QVBoxLayout* l1 = new QVBoxLayout(s1);
+        l1->setAlignment(Qt::AlignCenter);
+        l1->setSpacing(30);
+        QLabel* icon1 = new QLabel();
+        IconCache::instance()->apply(icon1, "input-keyboard", 96);
+        icon1->setAlignment(Qt::AlignCenter);
+        QLabel* t1 = new QLabel("Press the WIN Key");
+        t1->setObjectName("winKeyTitle");
+        t1->setAlignment(Qt::AlignCenter);
+        QLabel* d1 = new QLabel("This is how you open your application launcher\n(This key is also called Meta or Super key in Linux)");
+        QLabel* w2 = new QLabel("here are few shortcuts if you seek to know,\n meta+w - meta+d - meta+e .. check settings for more");
+        d1->setObjectName("winKeyText");
+        d1->setAlignment(Qt::AlignCenter);
+        w2->setObjectName("winKeyHint");
+        w2->setAlignment(Qt::AlignCenter);
+        l1->addWidget(icon1);
+        l1->addWidget(t1);
+        l1->addWidget(d1);
+        l1->addWidget(w2);
+        return s1;
+    }
+
+    QWidget* createLicenseStep() {
+        TRACE_SCOPE("createLicenseStep");
+        QWidget* s2 = new QWidget();
+        QVBoxLayout* l2 = new QVBoxLayout(s2);
+        l2->setAlignment(Qt::AlignCenter);
+        l2->setSpacing(25);
+        QLabel* icon2 = new QLabel();
+        IconCache::instance()->apply(icon2, ":/help.png", 120);
+        icon2->setAlignment(Qt::AlignCenter);
+        QLabel* t2 = new QLabel("License Agreement");
+        t2->setObjectName("licenseTitle");
+        t2->setAlignment(Qt::AlignCenter);
+        QLabel* d2 = new QLabel("Review to go ahead");
+        d2->setObjectName("licenseText");
+        d2->setAlignment(Qt::AlignCenter);
+
+        QPushButton* viewLicense = new QPushButton("View License");
+        viewLicense->setMinimumSize(200, 50);
+        viewLicense->setObjectName("viewLicenseButton");
+        connect(viewLicense, &QPushButton::clicked, [this]() {
+            LicenseViewer* viewer = new LicenseViewer(this);
+            viewer->setAttribute(Qt::WA_DeleteOnClose);
+            connect(viewer, &LicenseViewer::finished, this, [this]() {
+                licenseOK = true;
+                nextBtn->setEnabled(true);
+            });
+            viewer->show();
+        });
+
+        l2->addWidget(icon2);
+        l2->addWidget(t2);
+        l2->addWidget(d2);
+        l2->addWidget(viewLicense);
+        return s2;
+    }
+
+    QWidget* createPackageStep() {
+        TRACE_SCOPE("createPackageStep");
+        QWidget* s3 = new QWidget();
+        QVBoxLayout* l3 = new QVBoxLayout(s3);
+        l3->setSpacing(15);
+
+        QLabel* t3 = new QLabel("Choose Your Packages according to your needs,");
+        t3->setObjectName("packageTitle");
+        l3->addWidget(t3);
+
+        aptIndex = AptIndex::load(offlineRepo.isEmpty() ? QStringList() : QStringList{offlineRepo + "/Packages"});
+        resetResolver();
+
+        catalogSearch = new QLineEdit();
+        catalogSearch->setObjectName("catalogSearch");
+        catalogSearch->setPlaceholderText("Search profiles and packages");
+        catalogSearch->setClearButtonEnabled(true);
+        l3->addWidget(catalogSearch);
+
+        catalog = new CatalogModel(
+            profiles, selected, [this](const QString& id) { return profileTitle(id); },
+            [this](const QString& id) { return appListText(id); }, this);
+        connect(catalog, &CatalogModel::toggled, this, &OnboardingTour::toggleProfile);
+        connect(catalogSearch, &QLineEdit::textChanged, catalog, &CatalogModel::setFilter);
+
+        catalogView = new CatalogView();
+        catalogView->setObjectName("catalog");
+        catalogView->setModel(catalog);
+        l3->addWidget(catalogView, 1);
+
+        sizeLabel = new QLabel();
+        sizeLabel->setObjectName("sizeLabel");
+        l3->addWidget(sizeLabel);
+
+        cmdView = new RevealView();
+        cmdView->setRate([](double) { return 1.0 / 5; });
+        cmdView->setAnimated(DeviceTier::current().animated());
+        cmdView->setMaximumHeight(100);
+        cmdView->setObjectName("commandPreview");
+        l3->addWidget(cmdView);
+
+        installBar = new QProgressBar();
+        installBar->setRange(0, 100);
+        installBar->setTextVisible(false);
+        installBar->setFixedHeight(8);
+        installBar->setObjectName("installProgress");
+        installBar->setVisible(false);
+        installStatus = new QLabel();
+        installStatus->setObjectName("installStatus");
+        installStatus->setVisible(false);
+        installLog = new LogView();
+        installLog->setObjectName("installLog");
+        installLog->setFixedHeight(180);
+        installLog->setVisible(false);
+        l3->addWidget(installBar);
+        l3->addWidget(installStatus);
+        l3->addWidget(installLog);
+
+        return s3;
+    }
+
+    QWidget* createDoneStep() {
+        TRACE_SCOPE("createDoneStep");
+        QWidget* s4 = new QWidget();
+        QVBoxLayout* l4 = new QVBoxLayout(s4);
+        l4->setAlignment(Qt::AlignCenter);
+        l4->setSpacing(30);
+        QLabel* icon4 = new QLabel();
+        IconCache::instance()->apply(icon4, "dialog-ok", 96);
+        icon4->setAlignment(Qt::AlignCenter);
+        QLabel* t4 = new QLabel("All Set!");
+        t4->setObjectName("doneTitle");
+        t4->setAlignment(Qt::AlignCenter);
+        QLabel* d4 = new QLabel("Setup is complete! Your packages are installed - Thats all enjoy error.os :)");
+        d4->setObjectName("doneText");
+        d4->setAlignment(Qt::AlignCenter);
+        d4->setWordWrap(true);
+        l4->addWidget(icon4);
+        l4->addWidget(t4);
+        l4->addWidget(d4);
+        return s4;
+    }
+
+    void showStep(int s) {
+        TRACE_SCOPE("showStep");
+        step = s;
+        ensureStep(s);
+        stack->setCurrentIndex(s);
+        if (DeviceTier::current().prebuildPages()) {
+            QTimer::singleShot(100, this, [this, s]() { ensureStep(s + 1); });
+        }
+        progress->setValue((s + 1) * 20);
+
+        backBtn->setVisible(s > 0);
+        backBtn->setEnabled(s > 0);
+
+        Theme::setState(nextBtn, "variant", s == 3 ? "install" : "");
+        if (s == 3) {
+            nextBtn->setText("Install and next");
+            updateCommand();
+        } else if (s == 4) {
+            nextBtn->setText("Finish");
+        } else {
+            nextBtn->setText("Next");
+        }
+
+        nextBtn->setEnabled(s == 0 || (s == 1 && winKeyPressed) || (s == 2 && licenseOK) || s == 3 || s == 4);
+    }
+
+    // Selected packages that are not installed yet.
+    QStringList selectedApps() const {
+        return InstallPlan::missing(packageIndex.packages(), installedPackages);
+    }
+
+    bool isSatisfied(const Profile& p) const {
+        if (!p.actions.isEmpty()) return false;
+        for (const QString& app : p.apps) {
+            if (!installedPackages.contains(app)) return false;
+        }
+        return true;
+    }
+
+    // One line per package and action of a profile, for its catalog row.
+    QString appListText(const QString& id) const {
+        const Profile& p = profiles.constFind(id).value();
+        QString appText;
+        for (const QString& app : p.apps) {
+            appText += "• " + app;
+            if (installedPackages.contains(app)) appText += "  ✓ installed";
+            QStringList others;
+            for (const QString& owner : packageIndex.owners(app)) {
+                if (owner != id) others << profiles.constFind(owner)->name;
+            }
+            if (!others.isEmpty()) appText += "   (also pulled in by " + others.join(", ") + ")";
+            appText += "\n";
+        }
+        for (const Action& a : p.actions) {
+            appText += "▸ " + a.preview() + "\n";
+        }
+        return appText;
+    }
+
+    void toggleProfile(const QString& id, bool on) {
+        if (on == selected.contains(id)) return;
+        if (on) {
+            selected.insert(id);
+            packageIndex.addProfile(id, profiles[id].apps);
+            resolver.addProfile(id, profiles[id].apps);
+        } else {
+            selected.remove(id);
+            packageIndex.removeProfile(id, profiles[id].apps);
+            resolver.removeProfile(id);
+        }
+        updateCommand();
+        refreshTitles();
+        // A different selection is a new install; the old one is not resumed.
+        if (journal.pending() && !installer->isRunning() && selected != journal.profiles()) journal.finish();
+    }
+
+    // Toggles are coalesced into one preview update per frame.
+    void updateCommand() {
+        if (commandPending) return;
+        commandPending = true;
+        QTimer::singleShot(16, this, &OnboardingTour::flushCommand);
+    }
+
+    void resetResolver() {
+        resolver.reset(&aptIndex, installedPackages);
+        for (const QString& id : std::as_const(selected)) resolver.addProfile(id, profiles[id].apps);
+    }
+
+    // Name, description and what toggling the profile costs, counting its
+    // whole dependency closure but only what no other selection needs.
+    QString profileTitle(const QString& id) {
+        const Profile& p = profiles[id];
+        const QString title = p.name + " - " + p.desc;
+        if (isSatisfied(p)) return title + " · already satisfied";
+        const PackageSize cost = resolver.marginal(id, p.apps);
+        if (cost.download == 0) return title;
+        const QString size = QLocale().formattedDataSize(cost.download);
+        return title + (selected.contains(id) ? " · " + size + " of its own" : " · adds " + size);
+    }
+
+    void refreshTitles() {
+        if (catalog) catalog->refresh();
+    }
+
+    void updateSizes() {
+        if (!sizeLabel) return;
+        const QStringList packages = selectedApps();
+        const PackageSize total = resolver.total();
+        const quint64 free = AptIndex::freeSpace();
+        QString text = QString("Download %1 · Installed %2 · Free %3")
+                           .arg(QLocale().formattedDataSize(total.download),
+                                QLocale().formattedDataSize(total.installed),
+                                QLocale().formattedDataSize(free));
+        if (resolver.packageCount() > 0) {
+            text += QString(" · %1 packages with dependencies").arg(resolver.packageCount());
+            if (resolver.sharedCount() > 0) {
+                text += QString(", %1 shared (%2)")
+                            .arg(resolver.sharedCount())
+                            .arg(QLocale().formattedDataSize(resolver.sharedCost().download));
+            }
+        }
+        qsizetype unknown = std::count_if(packages.cbegin(), packages.cend(),
+                                          [this](const QString& pkg) { return !aptIndex.contains(pkg); });
+        if (unknown > 0) text += QString(" · %1 not in the apt lists").arg(unknown);
+        const bool tooBig = free > 0 && total.installed > free;
+        if (tooBig) text = "Not enough disk space! " + text;
+        Theme::setState(sizeLabel, "error", tooBig);
+        sizeLabel->setText(text);
+    }
+
+    QList<Action> buildPlan() const {
+        return InstallPlan::build(profiles, selected, selectedApps());
+    }
+
+    void flushCommand() {
+        TRACE_SCOPE("flushCommand");
+        commandPending = false;
+        prefetcher->setPackages(selectedApps());
+
+        const QList<Action> plan = buildPlan();
+        if (selected.isEmpty()) {
+            targetCmd = "Select profiles to see installation command";
+        } else if (InstallPlan::isEmpty(plan)) {
+            targetCmd = "Everything selected is already installed";
+        } else {
+            targetCmd = InstallPlan::preview(plan);
+        }
+
+        if (cmdView) cmdView->replaceText(targetCmd);
+        updateSizes();
+    }
+
+    void handleNext() {
+        if (step == 3) {
+            if (offlineRepo.isEmpty() && !repoOffered) offerDiscoveredRepo();
+            if (commandPending) flushCommand();
+            const QList<Action> plan = buildPlan();
+            if (InstallPlan::isEmpty(plan)) {
+                journal.finish();
+                step++;
+                showStep(step);
+                return;
+            }
+            nextBtn->setEnabled(false);
+            backBtn->setEnabled(false);
+            // The preview and sizes must keep describing what is installed.
+            catalogSearch->setEnabled(false);
+            catalogView->setEnabled(false);
+            installBar->setValue(0);
+            installBar->setVisible(true);
+            Theme::setState(installStatus, "error", false);
+            installStatus->setText("Waiting for authorization...");
+            installStatus->setVisible(true);
+            installLog->begin();
+            installLog->setVisible(true);
+            prefetcher->stop();
+            if (!journal.begin(selected, plan)) installLog->appendLine("Cannot write " + InstallJournal::path());
+            installer->start(plan, offlineRepo.isEmpty() ? Prefetcher::archiveDir() : QString(), offlineRepo, &journal);
+        } else if (step < 4) {
+            step++;
+            showStep(step);
+        } else {
+            QString configPath = QStandardPaths::writableLocation(QStandardPaths::ConfigLocation);
+            QString autostartDir = configPath + "/autostart";
+            QDir().mkpath(autostartDir);
+            QString autostartFile = autostartDir + "/once.desktop";
+            QFile::remove(autostartFile);
+            qApp->quit();
+        }
+    }
+
+    // A repository found on mounted media is unsigned and could come from
+    // any stick that is plugged in, so it is only used once the user has
+    // seen where it is and agreed.
+    void offerDiscoveredRepo() {
+        repoOffered = true;
+        for (const QString& dir : OfflineRepo::discovered()) {
+            const auto reply = QMessageBox::question(
+                this, "Offline Repository",
+                "An offline package repository was found at\n" + dir + "\n\n"
+                "Its packages are not signed. Install from it only if you trust where it came from.",
+                QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+            if (reply == QMessageBox::Yes) {
+                offlineRepo = dir;
+                return;
+            }
+        }
+    }
+
+    // A previous install was interrupted. Its license was accepted and its
+    // profiles chosen, so go straight back to installing what is left.
+    void resumeInstall() {
+        for (const QString& id : std::as_const(selected)) packageIndex.removeProfile(id, profiles[id].apps);
+        selected.clear();
+        for (const QString& id : journal.profiles()) {
+            if (!profiles.contains(id)) continue;
+            selected.insert(id);
+            packageIndex.addProfile(id, profiles[id].apps);
+        }
+        resetResolver();
+        refreshTitles();
+        winKeyPressed = licenseOK = true;
+        showStep(3);
+        handleNext();
+    }
+
+    void handleBack() {
+        if (step > 0) {
+            step--;
+            showStep(step);
+        }
+    }
+
+    void installFinished(bool ok, const QString& error) {
+        catalogSearch->setEnabled(true);
+        catalogView->setEnabled(true);
+        if (ok) {
+            prefetcher->clear();
+            installedPackages = DpkgStatus::installed();
+            resetResolver();
+            refreshTitles();
+            installBar->setVisible(false);
+            installStatus->setVisible(false);
+            installLog->setVisible(false);
+            step++;
+            showStep(step);
+            return;
+        }
+        if (offlineRepo.isEmpty()) prefetcher->resume();
+        Theme::setState(installStatus, "error", true);
+        installStatus->setText(error + "\nThe full log is in " + LogView::logPath());
+        nextBtn->setText("Retry install");
+        nextBtn->setEnabled(true);
+        backBtn->setEnabled(true);
+    }
+
+    void handleClose() {
+        if (installer->isRunning()) {
+            QMessageBox::information(this, "Installing",
+                                     "Packages are still being installed.\n"
+                                     "Please wait until the installation has finished.");
+            return;
+        }
+        QString text = "Are you sure you want to close the setup?\n"
+                       "The setup will appear again on next startup.";
+        if (journal.pending()) text += "\nThe installation will continue where it stopped.";
+        QMessageBox::StandardButton reply = QMessageBox::question(
+            this,
+            "Close Setup?",
+            text,
+            QMessageBox::Yes | QMessageBox::No,
+            QMessageBox::No
+            );
+        if (reply == QMessageBox::Yes) {
+            qApp->quit();
+        }
+    }
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include <algorithm>
+
+// Package to selected-profiles index. Selecting or deselecting a profile
+// only touches that profile's packages, and the sorted install set is kept
+// up to date in place instead of being rebuilt on every toggle.
+class PackageIndex {
+public:
+    void addProfile(const QString& id, const QStringList& apps) {
+        for (const QString& app : apps) {
+            QStringList& owners = index[app];
+            if (owners.contains(id)) continue;
+            owners.append(id);
+            if (owners.size() == 1) {
+                sorted.insert(std::lower_bound(sorted.begin(), sorted.end(), app), app);
+            }
+        }
+    }
+
+    void removeProfile(const QString& id, const QStringList& apps) {
+        for (const QString& app : apps) {
+            auto it = index.find(app);
+            if (it == index.end() || !it->removeOne(id)) continue;
+            if (it->isEmpty()) {
+                index.erase(it);
+                auto pos = std::lower_bound(sorted.begin(), sorted.end(), app);
+                if (pos != sorted.end() && *pos == app) sorted.erase(pos);
+            }
+        }
+    }
+
+    // Sorted, duplicate free packages of all selected profiles.
+    const QStringList& packages() const { return sorted; }
+
+    // Selected profiles that pull in the package.
+    QStringList owners(const QString& app) const { return index.value(app); }
+
+    int refCount(const QString& app) const { return int(index.value(app).size()); }
+
+private:
+    QHash<QString, QStringList> index;
+    QStringList sorted;
+};
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QLabel>
+#include <QLayout>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimer>
+
+#include <algorithm>
+#include <deque>
+
+#include <unistd.h>
+
+#include "frameclock.h"
+
+// Field diagnostics, toggled with F12 in the wizard. Shows how long the
+// window's frames take to paint, how often the animation clock wakes up,
+// how late the event loop runs a timer and the resident memory. One sample
+// per second is kept, at most an hour of them, and Shift+F12 writes them
+// to a CSV file to attach to a bug report. Nothing runs until the first
+// F12; while shown the overlay probes four times a second and its own
+// once-a-second repaint is counted among the frames.
+class PerfOverlay : public QLabel {
+    Q_OBJECT
+public:
+    explicit PerfOverlay(QWidget* parent) : QLabel(parent) {
+        setObjectName("perfOverlay");
+        setAttribute(Qt::WA_TransparentForMouseEvents);
+        probe.setTimerType(Qt::PreciseTimer);
+        probe.setInterval(probeMs);
+        connect(&probe, &QTimer::timeout, this, &PerfOverlay::tick);
+        hide();
+    }
+
+    void toggle() {
+        if (isVisible()) {
+            probe.stop();
+            hide();
+            return;
+        }
+        clock.start();
+        lastProbe = windowStart = 0;
+        lastWakeups = FrameClock::instance()->wakeups();
+        frames = 0;
+        paintNs = maxPaintNs = latencyMs = 0;
+        probe.start();
+        setText("Collecting samples...");
+        adjustSize();
+        // Inside the window's content margins, clear of the rounded mask.
+        const QLayout* layout = parentWidget()->layout();
+        const QMargins margins = layout ? layout->contentsMargins() : QMargins();
+        move(margins.left(), margins.top());
+        show();
+        raise();
+    }
+
+    // The window reports each frame it painted and flushed.
+    void framePainted(qint64 nsecs) {
+        if (!isVisible()) return;
+        ++frames;
+        paintNs += nsecs;
+        maxPaintNs = std::max(maxPaintNs, nsecs);
+    }
+
+    // Writes every sample kept as CSV and returns the file, or an empty
+    // string if it could not be written.
+    QString exportSamples() {
+        const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+        const QString path = dir + "/perf-" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".csv";
+        QByteArray csv = "time_ms,frames,paint_avg_us,paint_max_us,wakeups_per_s,loop_latency_ms,rss_kib\n";
+        for (const Sample& s : samples) {
+            csv += QByteArray::number(s.timeMs) + ',' + QByteArray::number(s.frames) + ','
+                   + QByteArray::number(s.paintAvgUs) + ',' + QByteArray::number(s.paintMaxUs) + ','
+                   + QByteArray::number(s.wakeups) + ',' + QByteArray::number(s.latencyMs) + ','
+                   + QByteArray::number(s.rssKiB) + '\n';
+        }
+        QDir().mkpath(dir);
+        QSaveFile file(path);
+        const bool ok = file.open(QIODevice::WriteOnly) && file.write(csv) == csv.size() && file.commit();
+        note = ok ? "saved " + path : "cannot write " + path;
+        qInfo("once: %s", qPrintable(note));
+        return ok ? path : QString();
+    }
+
+private:
+    struct Sample {
+        qint64 timeMs;
+        int frames;
+        qint64 paintAvgUs;
+        qint64 paintMaxUs;
+        int wakeups;
+        qint64 latencyMs;
+        qint64 rssKiB;
+    };
+
+    static qint64 rssKiB() {
+        QFile statm("/proc/self/statm");
+        if (!statm.open(QIODevice::ReadOnly)) return 0;
+        const QList<QByteArray> fields = statm.readAll().split(' ');
+        return fields.value(1).toLongLong() * sysconf(_SC_PAGESIZE) / 1024;
+    }
+
+    void tick() {
+        const qint64 t = clock.elapsed();
+        latencyMs = std::max(latencyMs, t - lastProbe - probeMs);
+        lastProbe = t;
+        if (t - windowStart < 1000) return;
+
+        const int wakeups = FrameClock::instance()->wakeups();
+        Sample s;
+        s.timeMs = t;
+        s.frames = frames;
+        s.paintAvgUs = frames > 0 ? paintNs / frames / 1000 : 0;
+        s.paintMaxUs = maxPaintNs / 1000;
+        s.wakeups = int((wakeups - lastWakeups) * 1000 / (t - windowStart));
+        s.latencyMs = latencyMs;
+        s.rssKiB = rssKiB();
+        samples.push_back(s);
+        if (samples.size() > maxSamples) samples.pop_front();
+
+        windowStart = t;
+        lastWakeups = wakeups;
+        frames = 0;
+        paintNs = maxPaintNs = latencyMs = 0;
+        display(s);
+    }
+
+    void display(const Sample& s) {
+        QString text = QString("paint    %1 frames/s, avg %2 ms, max %3 ms\n"
+                               "wakeups  %4/s\n"
+                               "latency  %5 ms\n"
+                               "rss      %6 MiB\n"
+                               "F12 hide, Shift+F12 export")
+                           .arg(s.frames)
+                           .arg(s.paintAvgUs / 1000.0, 0, 'f', 2)
+                           .arg(s.paintMaxUs / 1000.0, 0, 'f', 2)
+                           .arg(s.wakeups)
+                           .arg(s.latencyMs)
+                           .arg(s.rssKiB / 1024.0, 0, 'f', 1);
+        if (!note.isEmpty()) text += "\n" + note;
+        setText(text);
+        adjustSize();
+    }
+
+    static constexpr int probeMs = 250;
+    static constexpr size_t maxSamples = 3600;
+    QTimer probe;
+    QElapsedTimer clock;
+    std::deque<Sample> samples;
+    QString note;
+    qint64 lastProbe = 0;
+    qint64 windowStart = 0;
+    int lastWakeups = 0;
+    int frames = 0;
+    qint64 paintNs = 0;
+    qint64 maxPaintNs = 0;
+    qint64 latencyMs = 0;
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <QObject>
+#include <QProcess>
+#include <QTimer>
+#include <QStandardPaths>
+#include <QDir>
+#include <QRegularExpression>
+
+#include <unistd.h>
+
+// Downloads the packages of the current selection in the background while
+// the user is still reading the first pages, so the install only has to
+// unpack. Runs unprivileged against a per-user apt cache.
+class Prefetcher : public QObject {
+    Q_OBJECT
+public:
+    explicit Prefetcher(QObject* parent = nullptr) : QObject(parent) {
+        debounce.setSingleShot(true);
+        debounce.setInterval(1500);
+        connect(&debounce, &QTimer::timeout, this, &Prefetcher::schedule);
+        connect(&proc, &QProcess::finished, this, &Prefetcher::processFinished);
+    }
+
+    static QString cacheDir() {
+        return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/prefetch";
+    }
+
+    static QString archiveDir() { return cacheDir() + "/archives"; }
+
+    void setPackages(QStringList packages) {
+        static const QRegularExpression pkgRe("^[a-z0-9][a-z0-9+.-]+$");
+        packages = packages.filter(pkgRe);
+        packages.sort();
+        if (packages == wanted) return;
+        wanted = packages;
+        if (!stopped) debounce.start();
+    }
+
+    // Pauses prefetching while the install owns apt; resume() lifts it.
+    void stop() {
+        stopped = true;
+        debounce.stop();
+        if (proc.state() != QProcess::NotRunning) {
+            proc.kill();
+            proc.waitForFinished(1000);
+        }
+    }
+
+    // Picks the current selection up again, e.g. after a failed install
+    // when the user may still change it.
+    void resume() {
+        if (!stopped) return;
+        stopped = false;
+        debounce.start();
+    }
+
+    void clear() { QDir(cacheDir()).removeRecursively(); }
+
+private slots:
+    void schedule() {
+        if (stopped) return;
+        if (proc.state() != QProcess::NotRunning) {
+            // A stale download is cancelled, an index update is left to finish.
+            if (stage == Download && running != wanted) proc.kill();
+            return;
+        }
+        if (!updated) {
+            run(Update, {"update"});
+        } else if (!wanted.isEmpty() && wanted != fetched) {
+            running = wanted;
+            run(Download, QStringList{"--download-only", "install"} + wanted);
+        }
+    }
+
+    void processFinished(int exitCode, QProcess::ExitStatus status) {
+        bool ok = status == QProcess::NormalExit && exitCode == 0;
+        bool cancelled = status == QProcess::CrashExit;
+        if (stage == Update) updated = ok;
+        else if (!cancelled) fetched = running;  // a failed set is not retried
+        stage = None;
+        if (ok || cancelled) schedule();
+    }
+
+private:
+    enum Stage { None, Update, Download };
+
+    void run(Stage s, const QStringList& command) {
+        QStringList args;
+        if (geteuid() != 0) {
+            QDir().mkpath(archiveDir() + "/partial");
+            QDir().mkpath(cacheDir() + "/lists/partial");
+            args << "-o" << "Debug::NoLocking=1"
+                 << "-o" << "Dir::Cache::Archives=" + archiveDir() + "/"
+                 << "-o" << "Dir::State::Lists=" + cacheDir() + "/lists/"
+                 << "-o" << "Dir::Cache::pkgcache="
+                 << "-o" << "Dir::Cache::srcpkgcache=";
+        }
+        args << "-q" << "-y" << command;
+        stage = s;
+        proc.start("apt-get", args);
+    }
+
+    QProcess proc;
+    QTimer debounce;
+    QStringList wanted;
+    QStringList running;
+    QStringList fetched;
+    Stage stage = None;
+    bool updated = false;
+    bool stopped = false;
+};
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cstring>
+
+#include "action.h"
+#include "trace.h"
+
+struct Profile {
+    QString name;
+    QString icon;
+    QString desc;
+    QStringList apps;
+    QList<Action> actions;
+    bool preselected = false;
+};
+
+// Loads the profile catalog from once/profiles/*.profiles in the XDG data
+// dirs. The parsed catalog is compiled into a binary cache that later
+// launches map straight into memory; it is rebuilt whenever a source file
+// is added, removed or modified.
+class ProfileCatalog {
+public:
+    static QMap<QString, Profile> load() {
+        TRACE_SCOPE("ProfileCatalog::load");
+        const QStringList sources = sourceFiles();
+        const quint64 fp = fingerprint(sources);
+        const QString cachePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/profiles.cache";
+
+        QMap<QString, Profile> profiles;
+        if (loadCache(cachePath, fp, profiles)) return profiles;
+
+        for (const QString& file : sources) parse(file, profiles);
+        writeCache(cachePath, fp, profiles);
+        return profiles;
+    }
+
+    static QStringList sourceFiles() {
+        QStringList files;
+        // locateAll() lists the highest priority dir first, later files override earlier ones.
+        QStringList dirs = QStandardPaths::locateAll(QStandardPaths::GenericDataLocation, "once/profiles",
+                                                     QStandardPaths::LocateDirectory);
+        std::reverse(dirs.begin(), dirs.end());
+        for (const QString& dir : dirs) {
+            for (const QFileInfo& fi : QDir(dir).entryInfoList({"*.profiles"}, QDir::Files, QDir::Name)) {
+                files << fi.absoluteFilePath();
+            }
+        }
+        if (files.isEmpty()) files << ":/profiles/error.os.profiles";
+        return files;
+    }
+
+    static void parse(const QString& path, QMap<QString, Profile>& profiles) {
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+        QTextStream in(&f);
+        Profile* current = nullptr;
+        while (!in.atEnd()) {
+            const QString line = in.readLine().trimmed();
+            if (line.isEmpty() || line.startsWith('#')) continue;
+            if (line.startsWith('[') && line.endsWith(']')) {
+                const QString id = line.mid(1, line.size() - 2).trimmed();
+                current = nullptr;
+                if (!Action::validId(id)) {
+                    qWarning("%s: invalid profile \"%s\"", qPrintable(path), qPrintable(id));
+                    continue;
+                }
+                current = &profiles[id];
+                *current = Profile();
+                continue;
+            }
+            int eq = line.indexOf('=');
+            if (!current || eq < 0) continue;
+            const QString key = line.left(eq).trimmed();
+            const QString value = line.mid(eq + 1).trimmed();
+            if (key == "name") current->name = value;
+            else if (key == "icon") current->icon = value;
+            else if (key == "desc") current->desc = value;
+            else if (key == "app" && !value.isEmpty()) current->apps << value;
+            else if (key == "default") current->preselected = value == "true";
+            else if (key == "action") {
+                Action a;
+                if (Action::parse(value, a)) current->actions << a;
+                else qWarning("%s: invalid action \"%s\"", qPrintable(path), qPrintable(value));
+            }
+        }
+    }
+
+private:
+    static constexpr quint32 cacheVersion = 2;
+
+    struct CacheString { quint32 offset; quint32 length; };
+    struct CacheHeader {
+        char magic[8];
+        quint32 version;
+        quint32 count;
+        quint64 fingerprint;
+        quint32 actionsOffset;
+        quint32 listsOffset;
+        quint32 poolOffset;
+        quint32 size;
+    };
+    struct CacheRecord {
+        CacheString id, name, icon, desc;
+        quint32 firstApp;
+        quint32 appCount;
+        quint32 firstAction;
+        quint32 actionCount;
+        quint32 flags;
+    };
+    struct CacheAction {
+        CacheString id;
+        quint32 kind;
+        quint32 firstArg, argCount;
+        quint32 firstAfter, afterCount;
+    };
+
+    static quint64 fingerprint(const QStringList& sources) {
+        quint64 h = 14695981039346656037ull ^ cacheVersion;
+        auto mix = [&h](const void* data, size_t len) {
+            auto* p = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < len; ++i) h = (h ^ p[i]) * 1099511628211ull;
+        };
+        for (const QString& file : sources) {
+            QFileInfo fi(file);
+            qint64 stamp[2] = {fi.lastModified().toMSecsSinceEpoch(), fi.size()};
+            mix(file.constData(), file.size() * sizeof(QChar));
+            mix(stamp, sizeof(stamp));
+        }
+        return h;
+    }
+
+    static bool loadCache(const QString& path, quint64 fp, QMap<QString, Profile>& profiles) {
+        // Profile strings point into the mapping without copying, so it stays
+        // mapped for the rest of the process.
+        static const uchar* mapped = nullptr;
+        static quint64 mappedFingerprint = 0;
+        if (!mapped || mappedFingerprint != fp) {
+            auto* file = new QFile(path);
+            const uchar* data = nullptr;
+            if (file->open(QIODevice::ReadOnly) && file->size() >= qint64(sizeof(CacheHeader))) {
+                data = file->map(0, file->size());
+            }
+            if (!data || !validCache(data, file->size(), fp)) {
+                delete file;
+                return false;
+            }
+            mapped = data;
+            mappedFingerprint = fp;
+        }
+
+        CacheHeader h;
+        std::memcpy(&h, mapped, sizeof(h));
+        auto* records = reinterpret_cast<const CacheRecord*>(mapped + sizeof(CacheHeader));
+        auto* actions = reinterpret_cast<const CacheAction*>(mapped + h.actionsOffset);
+        auto* lists = reinterpret_cast<const CacheString*>(mapped + h.listsOffset);
+        auto* pool = reinterpret_cast<const QChar*>(mapped + h.poolOffset);
+        auto str = [pool](const CacheString& s) { return QString::fromRawData(pool + s.offset, s.length); };
+        auto list = [&](quint32 first, quint32 count) {
+            QStringList out;
+            out.reserve(count);
+            for (quint32 i = 0; i < count; ++i) out << str(lists[first + i]);
+            return out;
+        };
+
+        for (quint32 i = 0; i < h.count; ++i) {
+            const CacheRecord& r = records[i];
+            Profile& p = profiles[str(r.id)];
+            p.name = str(r.name);
+            p.icon = str(r.icon);
+            p.desc = str(r.desc);
+            p.preselected = r.flags & 1;
+            p.apps = list(r.firstApp, r.appCount);
+            p.actions.reserve(r.actionCount);
+            for (quint32 a = 0; a < r.actionCount; ++a) {
+                const CacheAction& ca = actions[r.firstAction + a];
+                Action action;
+                action.id = str(ca.id);
+                action.kind = Action::Kind(ca.kind);
+                action.args = list(ca.firstArg, ca.argCount);
+                action.after = list(ca.firstAfter, ca.afterCount);
+                p.actions << action;
+            }
+        }
+        return true;
+    }
+
+    // Checks every offset, count and string of the cache against the mapped
+    // size before anything reads through it, so a truncated or corrupt file
+    // whose fingerprint still matches falls back to parsing the profiles.
+    static bool validCache(const uchar* data, qint64 size, quint64 fp) {
+        CacheHeader h;
+        std::memcpy(&h, data, sizeof(h));
+        if (std::memcmp(h.magic, "ONCEPROF", 8) != 0 || h.version != cacheVersion || h.fingerprint != fp
+            || h.size != size || h.actionsOffset > h.listsOffset || h.listsOffset > h.poolOffset
+            || h.poolOffset > size) {
+            return false;
+        }
+        if (sizeof(CacheHeader) + qint64(h.count) * sizeof(CacheRecord) != h.actionsOffset
+            || (h.listsOffset - h.actionsOffset) % sizeof(CacheAction) != 0
+            || (h.poolOffset - h.listsOffset) % sizeof(CacheString) != 0
+            || (size - h.poolOffset) % sizeof(QChar) != 0) {
+            return false;
+        }
+        const quint64 actionTotal = (h.listsOffset - h.actionsOffset) / sizeof(CacheAction);
+        const quint64 listTotal = (h.poolOffset - h.listsOffset) / sizeof(CacheString);
+        const quint64 poolChars = (size - h.poolOffset) / sizeof(QChar);
+
+        auto* records = reinterpret_cast<const CacheRecord*>(data + sizeof(CacheHeader));
+        auto* actions = reinterpret_cast<const CacheAction*>(data + h.actionsOffset);
+        auto* lists = reinterpret_cast<const CacheString*>(data + h.listsOffset);
+        auto str = [poolChars](const CacheString& s) { return quint64(s.offset) + s.length <= poolChars; };
+        auto list = [&](quint32 first, quint32 count) {
+            if (quint64(first) + count > listTotal) return false;
+            for (quint32 i = 0; i < count; ++i) {
+                if (!str(lists[first + i])) return false;
+            }
+            return true;
+        };
+
+        for (quint32 i = 0; i < h.count; ++i) {
+            const CacheRecord& r = records[i];
+            if (!str(r.id) || !str(r.name) || !str(r.icon) || !str(r.desc) || !list(r.firstApp, r.appCount)
+                || quint64(r.firstAction) + r.actionCount > actionTotal) {
+                return false;
+            }
+            for (quint32 a = 0; a < r.actionCount; ++a) {
+                const CacheAction& ca = actions[r.firstAction + a];
+                if (!str(ca.id) || ca.kind > Action::Run || !list(ca.firstArg, ca.argCount)
+                    || !list(ca.firstAfter, ca.afterCount)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    static void writeCache(const QString& path, quint64 fp, const QMap<QString, Profile>& profiles) {
+        QList<CacheRecord> records;
+        QList<CacheAction> actions;
+        QList<CacheString> lists;
+        QString pool;
+        auto add = [&pool](const QString& s) {
+            CacheString cs{quint32(pool.size()), quint32(s.size())};
+            pool += s;
+            return cs;
+        };
+        auto addList = [&](const QStringList& l) {
+            quint32 first = quint32(lists.size());
+            for (const QString& s : l) lists << add(s);
+            return first;
+        };
+        for (auto it = profiles.cbegin(); it != profiles.cend(); ++it) {
+            const Profile& p = it.value();
+            CacheRecord r{add(it.key()), add(p.name), add(p.icon), add(p.desc),
+                          addList(p.apps), quint32(p.apps.size()),
+                          quint32(actions.size()), quint32(p.actions.size()), p.preselected ? 1u : 0u};
+            for (const Action& a : p.actions) {
+                CacheAction ca{add(a.id), quint32(a.kind), 0, quint32(a.args.size()), 0, quint32(a.after.size())};
+                ca.firstArg = addList(a.args);
+                ca.firstAfter = addList(a.after);
+                actions << ca;
+            }
+            records << r;
+        }
+
+        CacheHeader h{};
+        std::memcpy(h.magic, "ONCEPROF", 8);
+        h.version = cacheVersion;
+        h.count = quint32(records.size());
+        h.fingerprint = fp;
+        h.actionsOffset = quint32(sizeof(CacheHeader) + records.size() * sizeof(CacheRecord));
+        h.listsOffset = quint32(h.actionsOffset + actions.size() * sizeof(CacheAction));
+        h.poolOffset = quint32(h.listsOffset + lists.size() * sizeof(CacheString));
+        h.size = quint32(h.poolOffset + pool.size() * sizeof(QChar));
+
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QSaveFile out(path);
+        if (!out.open(QIODevice::WriteOnly)) return;
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char*>(records.constData()), records.size() * sizeof(CacheRecord));
+        out.write(reinterpret_cast<const char*>(actions.constData()), actions.size() * sizeof(CacheAction));
+        out.write(reinterpret_cast<const char*>(lists.constData()), lists.size() * sizeof(CacheString));
+        out.write(reinterpret_cast<const char*>(pool.constData()), pool.size() * sizeof(QChar));
+        out.commit();
+    }
+};
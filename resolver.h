@@ -0,0 +1,116 @@
+#pragma once
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include <vector>
+
+#include "aptindex.h"
+#include "trace.h"
+
+// Transitive Depends/Pre-Depends closure of the selected profiles over an
+// AptIndex. Every package keeps a count of the selected profiles whose
+// closure contains it, so toggling a profile only walks that profile's
+// closure (computed once and kept) and the totals are updated in place.
+// Installed packages cost nothing and are not walked into.
+class DependencyResolver {
+public:
+    void reset(const AptIndex* apt, const QSet<QString>& installed) {
+        index = apt;
+        refs.assign(apt->count(), 0);
+        mark.assign(apt->count(), 0);
+        isInstalled.assign(apt->count(), false);
+        for (const QString& pkg : installed) {
+            const int id = apt->id(pkg);
+            if (id >= 0) isInstalled[id] = true;
+        }
+        closures.clear();
+        active.clear();
+        totalSize = sharedSize = PackageSize();
+        needed = shared = 0;
+    }
+
+    void addProfile(const QString& id, const QStringList& apps) {
+        if (!index || active.contains(id)) return;
+        active.insert(id);
+        for (quint32 n : closure(id, apps)) {
+            if (++refs[n] == 1) add(totalSize, n, needed, 1);
+            else if (refs[n] == 2) add(sharedSize, n, shared, 1);
+        }
+    }
+
+    void removeProfile(const QString& id) {
+        if (!index || !active.remove(id)) return;
+        for (quint32 n : std::as_const(closures)[id]) {
+            if (--refs[n] == 0) add(totalSize, n, needed, -1);
+            else if (refs[n] == 1) add(sharedSize, n, shared, -1);
+        }
+    }
+
+    // Everything the selection needs that is not installed yet.
+    PackageSize total() const { return totalSize; }
+    int packageCount() const { return needed; }
+
+    // The part of total() needed by more than one selected profile.
+    PackageSize sharedCost() const { return sharedSize; }
+    int sharedCount() const { return shared; }
+
+    // What toggling the profile changes: for a selected profile what only
+    // it needs, for an unselected one what selecting it would add.
+    PackageSize marginal(const QString& id, const QStringList& apps) {
+        PackageSize cost;
+        if (!index) return cost;
+        const int alone = active.contains(id) ? 1 : 0;
+        for (quint32 n : closure(id, apps)) {
+            if (refs[n] != alone) continue;
+            const PackageSize s = index->size(int(n));
+            cost.download += s.download;
+            cost.installed += s.installed;
+        }
+        return cost;
+    }
+
+private:
+    void add(PackageSize& sum, quint32 n, int& count, int sign) {
+        const PackageSize s = index->size(int(n));
+        sum.download += sign * qint64(s.download);
+        sum.installed += sign * qint64(s.installed);
+        count += sign;
+    }
+
+    // Breadth first over the index; a generation counter in mark avoids
+    // clearing a visited set per walk.
+    const std::vector<quint32>& closure(const QString& id, const QStringList& apps) {
+        auto it = closures.find(id);
+        if (it != closures.end()) return *it;
+        TRACE_SCOPE("DependencyResolver::closure");
+        ++generation;
+        std::vector<quint32> result;
+        auto visit = [&](int n) {
+            if (n < 0 || mark[n] == generation || isInstalled[n]) return;
+            mark[n] = generation;
+            result.push_back(quint32(n));
+        };
+        for (const QString& app : apps) visit(index->id(app));
+        for (size_t i = 0; i < result.size(); ++i) {
+            for (const quint32* d = index->depsBegin(int(result[i])); d != index->depsEnd(int(result[i])); ++d) {
+                visit(int(*d));
+            }
+        }
+        return *closures.insert(id, std::move(result));
+    }
+
+    const AptIndex* index = nullptr;
+    std::vector<quint16> refs;
+    std::vector<quint32> mark;
+    std::vector<bool> isInstalled;
+    quint32 generation = 0;
+    QHash<QString, std::vector<quint32>> closures;
+    QSet<QString> active;
+    PackageSize totalSize;
+    PackageSize sharedSize;
+    int needed = 0;
+    int shared = 0;
+};
@@ -0,0 +1,277 @@
+#pragma once
+
+#include <QAbstractScrollArea>
+#include <QScrollBar>
+#include <QTextLayout>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QRegion>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "frameclock.h"
+#include "trace.h"
+
+// Typewriter text view. The whole text is laid out once per width and the
+// animation only moves the visible-character boundary, so a frame costs
+// the same no matter how long the text is. Characters in [boundary, spanEnd)
+// are hidden; replaceText() uses the span to animate just what changed.
+class RevealView : public QAbstractScrollArea {
+    Q_OBJECT
+public:
+    explicit RevealView(QWidget* parent = nullptr) : QAbstractScrollArea(parent) {
+        setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+        viewport()->setCursor(Qt::ArrowCursor);
+    }
+
+    const QString& text() const { return fullText; }
+    bool isRevealing() const { return FrameClock::instance()->isRunning(this); }
+
+    // Characters per millisecond as a function of the revealed fraction.
+    void setRate(std::function<double(double)> rate) { charsPerMs = std::move(rate); }
+
+    void setText(const QString& text) {
+        FrameClock::instance()->stop(this);
+        fullText = text;
+        boundary = 0;
+        spanEnd = text.size();
+        pending = 0;
+        relayout();
+    }
+
+    // Swaps in text and reveals only the span that differs from the current
+    // text, merged with whatever was still hidden.
+    void replaceText(const QString& text) {
+        const QString& old = fullText;
+        const qsizetype oldSize = old.size();
+        const qsizetype newSize = text.size();
+        qsizetype prefix = 0;
+        while (prefix < std::min(oldSize, newSize) && old[prefix] == text[prefix]) ++prefix;
+        qsizetype suffix = 0;
+        while (suffix < std::min(oldSize, newSize) - prefix
+               && old[oldSize - 1 - suffix] == text[newSize - 1 - suffix]) {
+            ++suffix;
+        }
+        if (prefix == oldSize && oldSize == newSize) return;
+
+        qsizetype from = prefix;
+        qsizetype to = newSize - suffix;
+        if (boundary < spanEnd) {
+            auto map = [&](qsizetype i, qsizetype inside) {
+                if (i <= prefix) return i;
+                if (i >= oldSize - suffix) return i + newSize - oldSize;
+                return inside;
+            };
+            from = std::min(from, map(boundary, prefix));
+            to = std::max(to, map(spanEnd, newSize - suffix));
+        }
+
+        FrameClock::instance()->stop(this);
+        fullText = text;
+        boundary = from;
+        spanEnd = to;
+        pending = 0;
+        relayout();
+        startReveal();
+    }
+
+    // When not animated, text is revealed as soon as it is set.
+    void setAnimated(bool on) { animated = on; }
+
+    void startReveal() {
+        if (!animated && boundary < spanEnd) {
+            revealAll();
+            return;
+        }
+        if (boundary >= spanEnd) {
+            emit revealFinished();
+            return;
+        }
+        FrameClock::instance()->start(this, [this]() { tick(); });
+        lastFrame = FrameClock::instance()->frameTime();
+    }
+
+    void revealAll() {
+        FrameClock::instance()->stop(this);
+        setBoundary(spanEnd);
+        finishSpan();
+        emit revealFinished();
+    }
+
+signals:
+    void revealFinished();
+
+protected:
+    void paintEvent(QPaintEvent* e) override {
+        TRACE_SCOPE("RevealView::paint");
+        QPainter p(viewport());
+        p.setPen(palette().color(QPalette::Text));
+        const qreal dy = margin - verticalScrollBar()->value();
+        const QRect area = e->rect();
+
+        auto it = std::lower_bound(lines.begin(), lines.end(), area.top() - dy,
+                                   [](const Line& l, qreal y) { return l.y + l.height < y; });
+        for (; it != lines.end() && it->y + dy <= area.bottom(); ++it) {
+            // Line positions are relative to their paragraph's layout.
+            const QTextLayout* layout = layouts[it->para].get();
+            QTextLine line = layout->lineAt(it->line);
+            const QPointF pos(margin, dy + layout->position().y());
+            if (it->end <= boundary || it->start >= spanEnd) {
+                line.draw(&p, pos);
+                continue;
+            }
+            const qsizetype base = paraStart[it->para];
+            QRegion clip;
+            if (boundary > it->start) {
+                qreal x = line.cursorToX(int(boundary - base));
+                clip += QRectF(margin, it->y + dy, x, it->height).toAlignedRect();
+            }
+            if (spanEnd < it->end) {
+                qreal x = line.cursorToX(int(spanEnd - base));
+                clip += QRectF(margin + x, it->y + dy, viewport()->width() - margin - x, it->height).toAlignedRect();
+            }
+            if (clip.isEmpty()) continue;
+            p.save();
+            p.setClipRegion(clip);
+            line.draw(&p, pos);
+            p.restore();
+        }
+    }
+
+    void resizeEvent(QResizeEvent* e) override {
+        QAbstractScrollArea::resizeEvent(e);
+        if (viewport()->width() != laidOutWidth) relayout();
+        else updateScrollRange();
+    }
+
+    void changeEvent(QEvent* e) override {
+        QAbstractScrollArea::changeEvent(e);
+        if (e->type() == QEvent::FontChange) relayout();
+    }
+
+    void scrollContentsBy(int dx, int dy) override { viewport()->scroll(dx, dy); }
+
+private:
+    void tick() {
+        TRACE_SCOPE("RevealView::tick");
+        const double progress = fullText.isEmpty() ? 1.0 : double(boundary) / fullText.size();
+        const qint64 now = FrameClock::instance()->frameTime();
+        pending += (now - lastFrame) * (charsPerMs ? charsPerMs(progress) : 0.2);
+        lastFrame = now;
+        const int step = int(pending);
+        if (step <= 0) return;
+        pending -= step;
+        setBoundary(std::min(boundary + step, spanEnd));
+        if (boundary >= spanEnd) {
+            FrameClock::instance()->stop(this);
+            finishSpan();
+            emit revealFinished();
+        }
+    }
+
+    struct Line {
+        int para;
+        int line;
+        qsizetype start;
+        qsizetype end;
+        qreal y;
+        qreal height;
+    };
+
+    void relayout() {
+        layouts.clear();
+        lines.clear();
+        paraStart.clear();
+        laidOutWidth = viewport()->width();
+        const qreal width = std::max(1, laidOutWidth - 2 * margin);
+
+        QTextOption option;
+        option.setWrapMode(QTextOption::WrapAtWordBoundaryOrAnywhere);
+        qreal y = 0;
+        qsizetype start = 0;
+        const QStringList paragraphs = fullText.split('\n');
+        for (const QString& para : paragraphs) {
+            auto layout = std::make_unique<QTextLayout>(para, font());
+            layout->setTextOption(option);
+            layout->setCacheEnabled(true);
+            layout->beginLayout();
+            qreal lineY = 0;
+            for (QTextLine line = layout->createLine(); line.isValid(); line = layout->createLine()) {
+                line.setLineWidth(width);
+                line.setPosition(QPointF(0, lineY));
+                lines.push_back({int(layouts.size()), line.lineNumber(), start + line.textStart(),
+                                 start + line.textStart() + line.textLength(), y + lineY, line.height()});
+                lineY += line.height();
+            }
+            layout->endLayout();
+            layout->setPosition(QPointF(0, y));
+            // An empty paragraph still has one line; keep its newline in the range.
+            if (!lines.empty()) lines.back().end += 1;
+            paraStart.push_back(start);
+            layouts.push_back(std::move(layout));
+            y += lineY;
+            start += para.size() + 1;
+        }
+        updateScrollRange();
+        viewport()->update();
+    }
+
+    // Returns the line holding character pos.
+    std::vector<Line>::const_iterator lineFor(qsizetype pos) const {
+        auto it = std::upper_bound(lines.cbegin(), lines.cend(), pos,
+                                   [](qsizetype p, const Line& l) { return p < l.start; });
+        return it == lines.cbegin() ? it : it - 1;
+    }
+
+    void setBoundary(qsizetype b) {
+        if (b == boundary || lines.empty()) {
+            boundary = b;
+            return;
+        }
+        auto first = lineFor(std::min(b, boundary));
+        auto last = lineFor(std::max(b, boundary));
+        boundary = b;
+        updateScrollRange();
+
+        const int bottom = int(last->y + last->height) + 2 * margin;
+        if (bottom - verticalScrollBar()->value() > viewport()->height()) {
+            verticalScrollBar()->setValue(bottom - viewport()->height());
+        }
+
+        const qreal dy = margin - verticalScrollBar()->value();
+        viewport()->update(QRectF(0, first->y + dy, viewport()->width(), last->y + last->height - first->y)
+                               .toAlignedRect());
+    }
+
+    void finishSpan() { boundary = spanEnd = fullText.size(); }
+
+    void updateScrollRange() {
+        // Only the revealed part scrolls; text behind a span is already visible.
+        const qsizetype revealed = spanEnd < fullText.size() ? fullText.size() : boundary;
+        qreal height = 0;
+        if (!lines.empty() && revealed > 0) {
+            auto last = lineFor(revealed - 1);
+            height = last->y + last->height;
+        }
+        verticalScrollBar()->setPageStep(viewport()->height());
+        verticalScrollBar()->setSingleStep(fontMetrics().height());
+        verticalScrollBar()->setRange(0, std::max(0, int(height) + 2 * margin - viewport()->height()));
+    }
+
+    static constexpr int margin = 4;
+
+    QString fullText;
+    std::vector<std::unique_ptr<QTextLayout>> layouts;
+    std::vector<qsizetype> paraStart;
+    std::vector<Line> lines;
+    int laidOutWidth = -1;
+    qsizetype boundary = 0;
+    qsizetype spanEnd = 0;
+    double pending = 0;
+    std::function<double(double)> charsPerMs;
+    bool animated = true;
+    qint64 lastFrame = 0;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <QApplication>
+#include <QFile>
+#include <QStyle>
+#include <QVariant>
+#include <QWidget>
+
+#include "trace.h"
+
+// One application stylesheet (theme.qss) instead of a stylesheet per
+// widget. It is parsed once; widgets only carry object names and, for
+// their few visual states, dynamic properties.
+class Theme {
+public:
+    static void apply(QApplication& app) {
+        TRACE_SCOPE("Theme::apply");
+        QFile qss(":/theme.qss");
+        if (qss.open(QIODevice::ReadOnly)) app.setStyleSheet(QString::fromUtf8(qss.readAll()));
+    }
+
+    // Switches a property used in the theme's selectors. Only an actual
+    // change re-polishes the widget, so repeated calls are free.
+    static void setState(QWidget* w, const char* name, const QVariant& value) {
+        if (w->property(name) == value) return;
+        w->setProperty(name, value);
+        w->style()->unpolish(w);
+        w->style()->polish(w);
+        w->update();
+    }
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <cstdio>
+#include <vector>
+
+#include <unistd.h>
+
+// Scoped timing spans dumped as a Chrome trace_event file, viewable in
+// chrome://tracing or ui.perfetto.dev. Tracing is off unless ONCE_TRACE
+// names the output file:
+//   ONCE_TRACE=/tmp/once.json once
+// A disabled span costs one predictable branch. Names must be string
+// literals, they are stored by pointer.
+class Trace {
+public:
+    static bool enabled() { return instance().active; }
+
+    // Starts the clock; call first thing in main() so spans are relative
+    // to process start rather than to the first span.
+    static void init() { instance(); }
+
+    static qint64 now() { return instance().clock.nsecsElapsed(); }
+
+    static void complete(const char* name, qint64 start, qint64 end) {
+        Trace& t = instance();
+        const quintptr tid = quintptr(QThread::currentThreadId());
+        QMutexLocker lock(&t.mutex);
+        t.events.push_back({name, start, end - start, tid, 'X'});
+    }
+
+    static void instant(const char* name) {
+        if (!enabled()) return;
+        Trace& t = instance();
+        const qint64 ts = now();
+        const quintptr tid = quintptr(QThread::currentThreadId());
+        QMutexLocker lock(&t.mutex);
+        t.events.push_back({name, ts, 0, tid, 'i'});
+    }
+
+    class Span {
+    public:
+        explicit Span(const char* name) : name(Trace::enabled() ? name : nullptr) {
+            if (this->name) start = Trace::now();
+        }
+        ~Span() {
+            if (name) Trace::complete(name, start, Trace::now());
+        }
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* name;
+        qint64 start = 0;
+    };
+
+private:
+    struct Event {
+        const char* name;
+        qint64 ts;
+        qint64 dur;
+        quintptr tid;
+        char phase;
+    };
+
+    Trace() {
+        path = qgetenv("ONCE_TRACE");
+        active = !path.isEmpty();
+        clock.start();
+    }
+
+    // Written from the static destructor with plain stdio so it also
+    // covers exit paths that never return to main().
+    ~Trace() {
+        if (!active) return;
+        std::FILE* f = std::fopen(path.constData(), "w");
+        if (!f) return;
+        std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+        const long long pid = getpid();
+        for (size_t i = 0; i < events.size(); ++i) {
+            const Event& e = events[i];
+            std::fprintf(f, "%s{\"name\":\"%s\",\"cat\":\"once\",\"ph\":\"%c\",\"ts\":%.3f,", i ? ",\n" : "",
+                         e.name, e.phase, e.ts / 1000.0);
+            if (e.phase == 'X') std::fprintf(f, "\"dur\":%.3f,", e.dur / 1000.0);
+            else std::fputs("\"s\":\"t\",", f);
+            std::fprintf(f, "\"pid\":%lld,\"tid\":%llu}", pid, (unsigned long long)e.tid);
+        }
+        std::fputs("\n]}\n", f);
+        std::fclose(f);
+    }
+
+    static Trace& instance() {
+        static Trace t;
+        return t;
+    }
+
+    QByteArray path;
+    bool active = false;
+    QElapsedTimer clock;
+    QMutex mutex;
+    std::vector<Event> events;
+};
+
+#define ONCE_TRACE_CAT2(a, b) a##b
+#define ONCE_TRACE_CAT(a, b) ONCE_TRACE_CAT2(a, b)
+#define TRACE_SCOPE(name) Trace::Span ONCE_TRACE_CAT(traceSpan, __LINE__)(name)